@@ -65,6 +65,15 @@ else
     }
 
     TARGET_DIR=/var/log
+
+    # the config last applied to each port is put back at boot straight
+    # away, before lldpad has heard from the switch
+    CONFIG_CACHE_DIR=/var/lib/slingshot-network-config
+    mkdir -p $CONFIG_CACHE_DIR && LLDP_ARGS="${LLDP_ARGS} --config-cache $CONFIG_CACHE_DIR/lldp-config.cache"
+
+    # counters for node_exporter's textfile collector, kept across runs
+    METRICS_DIR=/run/slingshot-network-config
+    mkdir -p $METRICS_DIR && LLDP_ARGS="${LLDP_ARGS} --metrics $METRICS_DIR/lldp.prom"
 fi
 
 function config_device() {
@@ -101,14 +110,6 @@ function config_device() {
             fi
         fi
 
-        # Check that TLV is present; print problematic PCI device if not
-        if [[ -z $(lldptool -tni $IFNAME) ]] ; then
-            PCIDEVICE=$(ethtool -i $IFNAME | grep bus | awk '{print $2}')
-            warn "Unable to pull TLV for interface $IFNAME. Failed to configure PCI device $PCIDEVICE"
-            EXIT=1
-            continue
-        fi
-
         LIST+=" $IFNAME"
     done
 }
@@ -177,6 +178,7 @@ function main() {
 
     EXIT=0
     LIST=""
+    WAIT_ARGS=""
 
     CFG_LLDP_TIMER_STATE=/tmp/_cfg_lldp_timer_state
     if [[ -r $CFG_LLDP_TIMER_STATE ]]; then
@@ -196,15 +198,35 @@ function main() {
             # Prod lldpad to pick up interfaces we just set up
             kill -s HUP $(lldptool ping)
         fi
-        # Give the switches time to send LLDP info
-        sleep $_timer
+        # Give the switches time to send LLDP info, each interface is
+        # configured as soon as its own CrayTLV shows up
+        WAIT_ARGS="--wait $_timer"
     fi
 
+    # Configure every interface at once; the binary works through them in parallel
+    LIST=$(echo $LIST)
+    if [[ -n $LIST ]] ; then
+        info "Configuring ${LIST// /,}, see /tmp/slingshot-lldp.log or /var/log/slingshot-lldp.log for output" 1>&2
+        SUMMARY=$(slingshot-network-cfg-lldp -v ${LLDP_ARGS} ${WAIT_ARGS} ${LIST// /,} 2>> ${TARGET_DIR}/slingshot-lldp.log)
+        if [[ $? -eq 0 ]]; then
+            for IFNAME in $LIST; do
+                ip addr show dev $IFNAME 1>&2
+            done
+            LIST=""
+        elif [[ -n $SUMMARY ]]; then
+            # only retry the interfaces the summary reports as failed
+            LIST=$(echo "$SUMMARY" | awk '$2 == "FAILED" { print $1 }')
+        fi
+        [[ -n $SUMMARY ]] && echo "$SUMMARY" >> ${TARGET_DIR}/slingshot-lldp.log
+    fi
+
+    # Retry the interfaces that did not come up one at a time
     for IFNAME in $LIST; do
         info "Configuring $IFNAME, see /tmp/slingshot-lldp.log or /var/log/slingshot-lldp.log for output" 1>&2
         retry_function 15 slingshot-network-cfg-lldp -v ${LLDP_ARGS} $IFNAME &>> ${TARGET_DIR}/slingshot-lldp.log
         if [[ $? -ne 0 ]]; then
-            warn "Configuration via LLDP failed for interface $IFNAME"
+            PCIDEVICE=$(ethtool -i $IFNAME | grep bus | awk '{print $2}')
+            warn "Configuration via LLDP failed for interface $IFNAME, PCI device $PCIDEVICE"
             EXIT=1
             continue
         fi
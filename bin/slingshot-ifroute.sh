@@ -13,6 +13,13 @@
 
 SCRIPT_NAME=$(basename "$0")
 
+# the compiled helper does the same work over a single netlink session,
+# set SLINGSHOT_IFROUTE_SCRIPT to use this script anyway
+IFROUTE_BIN="$(dirname "$(readlink -f "$0")")/slingshot-ifroute"
+if [[ -z "$SLINGSHOT_IFROUTE_SCRIPT" && -x "$IFROUTE_BIN" ]] ; then
+    exec "$IFROUTE_BIN" "$@"
+fi
+
 function usage() {
     echo -e """
 Usage: $SCRIPT_NAME [INTERFACE] [STATUS]
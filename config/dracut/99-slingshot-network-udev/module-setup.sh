@@ -11,5 +11,5 @@ depends() {
 
 install() {
 	inst_rules 99-slingshot-network.rules
-	inst_script /usr/bin/slingshot-ifname /usr/bin/slingshot-ifname
+	inst_binary /usr/bin/slingshot-ifname /usr/bin/slingshot-ifname
 }
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_CACHE_H
+#define INCLUDE_CACHE_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tlv.h"
+
+struct cache_entry;
+
+/* one per struct netcfg, nothing is cached until it is loaded */
+struct config_cache {
+    pthread_mutex_t lock;
+    struct cache_entry *entries;
+    int count;
+    char *path;
+};
+
+void config_cache_init(struct config_cache *cache);
+
+bool config_cache_load(struct config_cache *cache, const char *path);
+
+void config_cache_free(struct config_cache *cache);
+
+bool config_cache_lookup(struct config_cache *cache, fabric_config_t *fc);
+
+void config_cache_store(struct config_cache *cache, const fabric_config_t *fc);
+
+#endif /* INCLUDE_CACHE_H */
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_CFG_LLDP_H
+#define INCLUDE_CFG_LLDP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "cache.h"
+#include "clif.h"
+#include "debug.h"
+#include "hostmap.h"
+#include "metrics.h"
+#include "netlink.h"
+#include "tlv.h"
+
+struct program_options {
+    bool batch;
+    char *config_cache;
+    bool create_ifcfg;
+    bool daemon;
+    bool defer_reload;
+    bool dry_run;
+    bool force;
+    char *host_map;
+    bool remove_ip_addrs;
+    char *input_file;
+    bool ip_cmds;
+    int jobs;
+    bool lldpad_clif;
+    char *lldpad_socket;
+    char *metrics;
+    bool native_lldp;
+    bool skip_reload;
+    bool verify;
+    int wait;
+};
+
+/*
+ * Everything a configuration run depends on besides its interfaces. The
+ * tools make one, the library one per netcfg_new(), so callers with their
+ * own handle share no options, log settings, lldpad session, config
+ * cache, host map or metrics. Tracing is per process, only the tools
+ * turn it on.
+ */
+struct netcfg {
+    struct program_options options;
+    struct debug_sink log;
+    struct debug_capture capture;
+
+    /* the session with lldpad while options.lldpad_clif is set */
+    struct clif lldpad;
+
+    /* loaded from options.config_cache, host_map and metrics */
+    struct config_cache cache;
+    struct host_map host_map;
+    struct metrics metrics;
+
+    /* interfaces whose reload was deferred with options.defer_reload */
+    pthread_mutex_t reload_lock;
+    char **reload_queue;
+    int reload_count;
+};
+
+/* the outcome of configuring one interface */
+struct if_result {
+    fabric_config_t fc;
+    bool ok;
+    const char *status;
+    long elapsed_ms;
+    long tlv_ms;
+};
+
+/* apply_config() status when the wicked reload was left to the caller */
+#define STATUS_RELOAD_QUEUED "reload queued"
+
+/* cfg_lldp.c */
+
+bool lldpad_open(struct netcfg *nc, char **ifnames, int count);
+
+void lldpad_close(struct netcfg *nc);
+
+bool get_lldp_tlv(fabric_config_t *fc, const char *input_file,
+        char *org_tlv, size_t org_tlv_len);
+
+bool is_valid_tlv_data(fabric_config_t *fc);
+
+bool decode_tlv(fabric_config_t *fc, const char *org_tlv);
+
+bool parse_tlv(struct netcfg *nc, fabric_config_t *fc);
+
+bool parse_tlv_input(struct netcfg *nc, fabric_config_t *fc,
+        const char *input_file);
+
+bool wait_for_tlv(struct netcfg *nc, fabric_config_t *fc, long *tlv_ms);
+
+bool write_ifcfg(struct netcfg *nc, fabric_config_t *fc, bool *changed);
+
+bool reload_interfaces(struct netcfg *nc, char **ifnames, int count);
+
+bool reload_interface(struct netcfg *nc, fabric_config_t *fc);
+
+bool reload_queued_interfaces(struct netcfg *nc);
+
+bool do_ip_cmds(struct netcfg *nc, fabric_config_t *fc);
+
+bool plan_netlink_cmds(struct netcfg *nc, fabric_config_t *fc,
+        struct nl_batch *b);
+
+bool do_netlink_cmds(struct netcfg *nc, fabric_config_t *fc,
+        const char **status);
+
+bool apply_config(struct netcfg *nc, fabric_config_t *fc,
+        const char **status);
+
+bool configure_interface(struct netcfg *nc, fabric_config_t *fc,
+        const char **status, long *tlv_ms);
+
+bool configure_interfaces(struct netcfg *nc, struct if_result *results,
+        int count);
+
+/* daemon.c */
+int run_daemon(struct netcfg *nc, char **ifnames, int count);
+
+/* batch.c */
+
+/* the start of every result run_captured() works on */
+struct captured_result {
+    struct netcfg *nc;
+    fabric_config_t fc;
+    struct debug_capture reason;
+};
+
+typedef void (*captured_fn)(struct captured_result *res);
+
+void run_captured(struct netcfg *nc, void *results, size_t size, int count,
+        int threads, captured_fn fn);
+
+int run_batch(struct netcfg *nc, char **inputs, int count);
+
+/* verify.c */
+int run_verify(struct netcfg *nc, char **ifnames, int count);
+
+#endif /* INCLUDE_CFG_LLDP_H */
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_CLIF_H
+#define INCLUDE_CLIF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "tlv.h"
+
+/* abstract unix socket lldpad listens on for lldptool */
+#define CLIF_SOCK_NAME "/com/intel/lldpad"
+
+/* how long one request may take, and how often it is sent */
+#define CLIF_TIMEOUT_MS 2000
+#define CLIF_RETRIES    3
+
+#define CLIF_MSG_SIZE 4096
+
+/* message framing, as in open-lldp's clif_msgs.h */
+#define CLIF_MSG_VERSION 1
+#define CLIF_MOD_CMD     'M'
+#define CLIF_CMD_REQUEST 'C'
+#define CLIF_CMD_RESPONSE 'R'
+#define CLIF_EVENT_MSG   'E'
+
+#define CLIF_MOD_MAND    1
+#define CLIF_NEAREST_BRIDGE 0
+#define CLIF_INVALID_TLVID  128
+
+/* commands */
+#define CLIF_CMD_GETTLV   1
+#define CLIF_CMD_SETTLV   2
+#define CLIF_CMD_SET_LLDP 4
+
+/* command ops */
+#define CLIF_OP_LOCAL    0x01
+#define CLIF_OP_NEIGHBOR 0x02
+#define CLIF_OP_ARG      0x04
+#define CLIF_OP_ARGVAL   0x08
+#define CLIF_OP_CONFIG   0x10
+
+/* response status */
+#define CLIF_STATUS_SUCCESS          0
+#define CLIF_STATUS_DEVICE_NOT_FOUND 2
+#define CLIF_STATUS_BAD_PARAMS       5
+#define CLIF_STATUS_PEER_NOT_PRESENT 6
+
+/*
+ * A session with lldpad's control interface. One datagram socket is
+ * shared by every thread; requests are sent one at a time.
+ */
+struct clif {
+    int fd;
+    int timeout_ms;
+    pthread_mutex_t lock;
+};
+
+bool clif_open(struct clif *c, const char *sock_name, int timeout_ms);
+
+void clif_close(struct clif *c);
+
+int clif_request(struct clif *c, int cmd, uint32_t ops, const char *ifname,
+        const char *arg, const char *argval, char *payload, size_t payload_len);
+
+bool clif_set_admin_status(struct clif *c, const char *ifname,
+        const char *status);
+
+bool clif_get_tlvs(struct clif *c, const char *ifname, uint8_t *tlvs,
+        size_t size, size_t *len);
+
+bool clif_get_tlv(struct clif *c, fabric_config_t *fc, char *org_tlv,
+        size_t org_tlv_len);
+
+#endif /* INCLUDE_CLIF_H */
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 enum {
 	DEBUG_LVL_DEBUG,
@@ -42,10 +43,53 @@ enum {
 	DEBUG_LVL_MAX,
 };
 
-extern int debug_level;
+enum {
+	DEBUG_FORMAT_TEXT,
+	DEBUG_FORMAT_JSON,
+};
+
+/*
+ * Where log lines go and which of them are wanted. A library caller can
+ * give each of its handles one, with a callback that gets each message
+ * instead of stderr; the tools use the default.
+ */
+typedef void (*debug_log_fn)(void *arg, int dbg_lvl, const char *msg);
+
+struct debug_sink {
+	int level;
+	int format;
+	debug_log_fn fn;
+	void *arg;
+};
+
+extern struct debug_sink debug_default_sink;
+extern __thread struct debug_sink *debug_sink;
 extern char *log_level_labels[DEBUG_LVL_MAX];
+extern __thread char debug_context[32];
 
-void debug_fprintf(const char *file, const char *func, const int line, FILE* fp, char *fmt, ...);
+#define DEBUG_CAPTURE_SIZE 256
+
+/*
+ * Keeps the first error and diagnostic logged by a thread. With quiet
+ * set nothing the thread logs is written out.
+ */
+struct debug_capture {
+	char error[DEBUG_CAPTURE_SIZE];
+	char diag[DEBUG_CAPTURE_SIZE];
+	bool quiet;
+};
+
+extern __thread struct debug_capture *debug_capture;
+
+void debug_log(const char *file, const char *func, const int line, FILE *fp,
+	int dbg_lvl, const char *fmt, ...) __attribute__((format(printf, 6, 7)));
+
+void debug_flush(void);
+
+void debug_capture_msg(int dbg_lvl, const char *fmt, ...)
+	__attribute__((format(printf, 2, 3)));
+
+void debug_set_context(const char *context);
 
 static inline char *get_filename(char *fname)
 {
@@ -54,16 +98,15 @@ static inline char *get_filename(char *fname)
 }
 
 #define WRITE_TO_LOG(fp, dbg_lvl, fmt, args...) \
-	do { \
-		debug_fprintf(get_filename(__FILE__), __func__, __LINE__, fp, \
-                "[%s] - " fmt "", \
-				log_level_labels[dbg_lvl], ##args); \
-		fflush(fp); \
-	} while (0)
+	debug_log(get_filename(__FILE__), __func__, __LINE__, fp, \
+			dbg_lvl, fmt, ##args)
 
 #define COND_WRITE_TO_LOG(fp,dbg_lvl, fmt, args...) \
 	do { \
-		if (debug_level <= dbg_lvl) \
+		if (debug_capture && dbg_lvl >= DEBUG_LVL_ERROR) \
+			debug_capture_msg(dbg_lvl, fmt, ##args); \
+		if (debug_sink->level <= dbg_lvl && \
+				!(debug_capture && debug_capture->quiet)) \
 			WRITE_TO_LOG(fp, dbg_lvl, fmt, ##args); \
 	} while (0)
 
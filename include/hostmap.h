@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_HOSTMAP_H
+#define INCLUDE_HOSTMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tlv.h"
+
+/* largest subnet a single 'derive' line may expand, as a prefix length */
+#define HOST_MAP_MIN_DERIVE_PREFIX 16
+
+struct host_entry;
+
+/* one per struct netcfg, loaded before any interface is configured */
+struct host_map {
+    struct host_entry *entries;     /* sorted by address once loaded */
+    int count;
+    int size;
+    uint16_t state;                 /* NUD_* the entries are installed with */
+};
+
+void host_map_init(struct host_map *map);
+
+bool host_map_load(struct host_map *map, const char *path);
+
+void host_map_free(struct host_map *map);
+
+bool host_map_seed(const struct host_map *map, const fabric_config_t *fc,
+        bool dry_run);
+
+#endif /* INCLUDE_HOSTMAP_H */
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_LLDP_H
+#define INCLUDE_LLDP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tlv.h"
+
+/* Cray Org TLV identifiers */
+#define LLDP_CRAY_OUI     0x000eab
+#define LLDP_CRAY_SUBTYPE 1
+
+/* LLDP transmit interval is 30s by default, wait for two of them */
+#define LLDP_RECV_TIMEOUT 60
+
+#define LLDP_ORG_TLV_SIZE 512
+
+void lldp_decode_tlvs(const uint8_t *tlvs, size_t len, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_len);
+
+bool lldp_decode_frame(const uint8_t *frame, size_t len,
+        fabric_config_t *fc, char *org_tlv, size_t org_tlv_len);
+
+int lldp_open(const char *ifname);
+
+bool lldp_get_tlv(fabric_config_t *fc, const char *pcap_file, int timeout,
+        char *org_tlv, size_t org_tlv_len);
+
+bool lldp_check_tlv(const fabric_config_t *fc, const char *org_tlv);
+
+#endif /* INCLUDE_LLDP_H */
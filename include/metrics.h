@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_METRICS_H
+#define INCLUDE_METRICS_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tlv.h"
+
+/* why an attempt to configure an interface failed */
+enum metrics_failure {
+    METRICS_NO_LLDP_DATA,
+    METRICS_MISSING_ORG_TLV,
+    METRICS_INVALID_IP,
+    METRICS_INVALID_MTU,
+    METRICS_INVALID_TTL,
+    METRICS_COMMAND_FAILED,
+    METRICS_OTHER,          /* the CrayTLV was whole, the fetch failed anyway */
+    METRICS_FAILURE_MAX,
+};
+
+struct metrics_if;
+
+struct metrics_set {
+    struct metrics_if *ifs;
+    int count;
+};
+
+/*
+ * One per struct netcfg. pending is what has been seen since the file
+ * was last written. Writing adds it to whatever the file holds by then,
+ * so the tool run by the script and the daemon can both keep the same
+ * counters going.
+ */
+struct metrics {
+    pthread_mutex_t lock;
+    struct metrics_set pending;
+    bool dirty;
+    char *path;         /* NULL until opened, nothing is recorded */
+    int lock_fd;
+};
+
+void metrics_init(struct metrics *m);
+
+bool metrics_open(struct metrics *m, const char *path);
+
+void metrics_close(struct metrics *m);
+
+void metrics_tlv_fetched(struct metrics *m, const fabric_config_t *fc,
+        bool ok, long ms);
+
+void metrics_applied(struct metrics *m, const char *ifname, bool ok, long ms);
+
+void metrics_confirmed(struct metrics *m, const char *ifname);
+
+void metrics_flush(struct metrics *m);
+
+#endif /* INCLUDE_METRICS_H */
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_NETLINK_H
+#define INCLUDE_NETLINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+
+/* size of the scratch buffer a single request is built in */
+#define NL_MSG_SIZE 1024
+
+/* 'ip' uses this for valid_lft/preferred_lft forever */
+#define NL_LIFETIME_FOREVER 0xffffffffU
+
+/* IPv4 addresses remembered per interface by nl_link_state_get() */
+#define NL_MAX_ADDRS 16
+
+/*
+ * A batch of rtnetlink requests. Requests are queued with nl_batch_add()
+ * and sent together by nl_batch_commit(), which reports the result of
+ * every request by the description it was queued with.
+ */
+struct nl_batch {
+    int fd;
+    bool dry_run;
+    uint32_t seq;
+    char *buf;
+    size_t len;
+    size_t size;
+    char **desc;
+    int count;
+    int max;
+};
+
+/* what the kernel currently has for an interface */
+struct nl_link_state {
+    uint8_t mac_addr[6];
+    uint32_t mtu;
+    bool up;
+    int naddrs;
+    struct {
+        struct in_addr addr;
+        int prefix;
+        uint32_t valid_lft;
+        uint32_t preferred_lft;
+    } addrs[NL_MAX_ADDRS];
+};
+
+/* an IPv4 policy routing rule, as far as slingshot-ifroute uses them */
+struct nl_rule {
+    uint32_t pref;
+    uint32_t table;
+    struct in_addr src;
+    struct in_addr dst;
+    uint8_t src_len;
+    uint8_t dst_len;
+    char iifname[IFNAMSIZ];
+};
+
+/* an IPv4 unicast route, zero oif, gateway, priority or prefsrc are unset */
+struct nl_route {
+    uint32_t table;
+    struct in_addr dst;
+    uint8_t dst_len;
+    uint8_t protocol;
+    uint8_t scope;
+    uint32_t flags;
+    int oif;
+    struct in_addr gateway;
+    uint32_t priority;
+    struct in_addr prefsrc;
+};
+
+typedef void (*nl_dump_cb)(const struct nlmsghdr *n, void *arg);
+
+int nl_monitor_open(uint32_t groups);
+
+bool nl_batch_init(struct nl_batch *b, bool dry_run);
+
+void nl_batch_free(struct nl_batch *b);
+
+void nl_batch_reset(struct nl_batch *b);
+
+bool nl_batch_add(struct nl_batch *b, const struct nlmsghdr *n,
+        const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+int nl_batch_commit(struct nl_batch *b);
+
+bool nl_dump(struct nl_batch *b, uint16_t type, const void *hdr,
+        size_t hdr_len, nl_dump_cb cb, void *arg);
+
+void nl_msg_init(struct nlmsghdr *n, uint16_t type, uint16_t flags,
+        const void *hdr, size_t hdr_len);
+
+bool nl_attr_put(struct nlmsghdr *n, uint16_t type,
+        const void *data, size_t len);
+
+/* rtnetlink requests */
+bool nl_link_set_up(struct nl_batch *b, int ifindex, const char *ifname,
+        bool up);
+
+bool nl_link_set_addr(struct nl_batch *b, int ifindex, const char *ifname,
+        const uint8_t *mac_addr);
+
+bool nl_link_set_mtu(struct nl_batch *b, int ifindex, const char *ifname,
+        uint32_t mtu);
+
+bool nl_addr_add(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, int prefix, uint32_t valid_lft,
+        uint32_t preferred_lft, bool replace);
+
+bool nl_addr_del(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, int prefix);
+
+bool nl_addr_flush(struct nl_batch *b, int ifindex, const char *ifname);
+
+bool nl_link_state_get(struct nl_batch *b, int ifindex,
+        struct nl_link_state *st);
+
+bool nl_rule_list(struct nl_batch *b, struct nl_rule **rules, int *count);
+
+bool nl_rule_add(struct nl_batch *b, const struct nl_rule *r);
+
+bool nl_rule_del(struct nl_batch *b, const struct nl_rule *r);
+
+bool nl_route_list(struct nl_batch *b, struct nl_route **routes, int *count);
+
+bool nl_route_replace(struct nl_batch *b, const struct nl_route *r,
+        const char *ifname);
+
+bool nl_neigh_replace(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, const uint8_t *mac_addr, uint16_t state);
+
+bool nl_neigh_flush(struct nl_batch *b, const int *ifindexes, int count);
+
+#endif /* INCLUDE_NETLINK_H */
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INCLUDE_ROUTES_H
+#define INCLUDE_ROUTES_H
+
+#include <stdbool.h>
+#include <net/if.h>
+
+#include "netlink.h"
+
+/*
+ * A route read from a route file. The table and source address are
+ * left unset, they belong to the device the file is applied to.
+ */
+struct route_entry {
+    struct nl_route route;
+    char ifname[IFNAMSIZ];
+    int line;
+    char *ip_args;      /* the line as written when left to 'ip route' */
+};
+
+#define ROUTE_LINE_SIZE 512
+
+bool route_file_load(const char *path, struct route_entry **entries,
+        int *count);
+
+void route_file_free(struct route_entry *entries, int count);
+
+#endif /* INCLUDE_ROUTES_H */
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLINGSHOT_NETCFG_H
+#define SLINGSHOT_NETCFG_H
+
+/*
+ * libslingshot-netcfg: fetch the CrayTLV a Slingshot switch advertises on
+ * an HSN interface, turn it into a fabric config, and bring the interface
+ * in line with it, without running slingshot-network-cfg-lldp.
+ *
+ * Every call takes a handle from netcfg_new(). A handle is used by one
+ * thread at a time. Each handle has its own options, lldpad session,
+ * config cache, host map and metrics. The only thing the process shares
+ * is the buffer that log lines pass through on their way to stderr.
+ * Calls return true on success. On failure the reason has been logged,
+ * and the first error is also kept for netcfg_error().
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+#include <net/if.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* log levels, the callback only sees those at or above the one set */
+enum netcfg_log_level {
+    NETCFG_LOG_DEBUG,
+    NETCFG_LOG_VERBOSE,
+    NETCFG_LOG_WARN,
+    NETCFG_LOG_ERROR,
+    NETCFG_LOG_DIAG,
+    NETCFG_LOG_CRITICAL,
+    NETCFG_LOG_FATAL,
+    NETCFG_LOG_NONE,
+};
+
+/* netcfg_new() flags */
+#define NETCFG_DRY_RUN         0x01    /* plan and log, change nothing */
+#define NETCFG_FORCE           0x02    /* plan every step, not the difference */
+#define NETCFG_REMOVE_IP_ADDRS 0x04    /* remove addresses not in the config */
+#define NETCFG_SKIP_RELOAD     0x08    /* never take the link down and up */
+
+/* netcfg_config.have, which values the CrayTLV provided */
+#define NETCFG_HAVE_MAC 0x01
+#define NETCFG_HAVE_IP  0x02
+#define NETCFG_HAVE_MTU 0x04
+#define NETCFG_HAVE_TTL 0x08
+#define NETCFG_HAVE_ALL 0x0f
+
+/* netcfg_config.ttl for an address that does not expire */
+#define NETCFG_TTL_FOREVER 0xffffffffU
+
+/* the configuration the fabric wants for one interface */
+struct netcfg_config {
+    char ifname[IF_NAMESIZE];
+    unsigned int have;
+    uint8_t mac_addr[6];
+    struct in_addr ip_addr;
+    uint8_t prefix;
+    uint32_t mtu;
+    uint32_t ttl;
+};
+
+/* receives each message, already formatted and without a newline */
+typedef void (*netcfg_log_fn)(void *arg, int level, const char *msg);
+
+struct netcfg;
+struct netcfg_plan;
+
+struct netcfg *netcfg_new(unsigned int flags);
+
+void netcfg_free(struct netcfg *nc);
+
+/* without fn messages go to stderr; the default level is NETCFG_LOG_ERROR */
+void netcfg_set_log(struct netcfg *nc, int level, netcfg_log_fn fn,
+        void *arg);
+
+/* lldpad's abstract control socket name, for a lldpad run elsewhere */
+bool netcfg_set_lldpad_socket(struct netcfg *nc, const char *name);
+
+/* the first error logged by the last call that failed, kept until another fails */
+const char *netcfg_error(const struct netcfg *nc);
+
+/*
+ * Ask lldpad for the TLVs last received from the switch on ifname, as
+ * the raw LLDPDU TLVs. The session is opened on first use and kept.
+ */
+bool netcfg_fetch_tlv(struct netcfg *nc, const char *ifname, uint8_t *buf,
+        size_t size, size_t *len);
+
+/* decode LLDPDU TLVs into cfg, which is then checked by netcfg_validate() */
+bool netcfg_parse(struct netcfg *nc, const char *ifname, const uint8_t *buf,
+        size_t len, struct netcfg_config *cfg);
+
+bool netcfg_validate(struct netcfg *nc, const struct netcfg_config *cfg);
+
+/*
+ * Work out the changes that take cfg's interface from its current state
+ * to cfg. A plan with no steps means the interface already matches.
+ */
+bool netcfg_plan(struct netcfg *nc, const struct netcfg_config *cfg,
+        struct netcfg_plan **plan);
+
+int netcfg_plan_steps(const struct netcfg_plan *plan);
+
+/* a step as an ip(8)-like description, e.g. for logging the plan */
+const char *netcfg_plan_step(const struct netcfg_plan *plan, int idx);
+
+bool netcfg_apply(struct netcfg *nc, struct netcfg_plan *plan);
+
+void netcfg_plan_free(struct netcfg_plan *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLINGSHOT_NETCFG_H */
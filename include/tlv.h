@@ -27,14 +27,87 @@
 #ifndef INCLUDE_TLV_H
 #define INCLUDE_TLV_H
 
-#define MAC_ADDR_SIZE 24
-#define IP_ADDR_SIZE  32
-#define MTU_SIZE      16
-#define TTL_SIZE      16
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
 
-void parse_mac_addr(const char *buf, char *mac_addr);
+/* fields of a fabric config that have been filled in */
+#define FC_HAVE_MAC  0x1
+#define FC_HAVE_IP   0x2
+#define FC_HAVE_MTU  0x4
+#define FC_HAVE_TTL  0x8
+#define FC_HAVE_ALL  (FC_HAVE_MAC | FC_HAVE_IP | FC_HAVE_MTU | FC_HAVE_TTL)
 
-void parse_org_tlv(const char *buf, char *org_tlv);
+/* an address lifetime that never runs out, as rtnetlink has it */
+#define FC_TTL_FOREVER 0xffffffffU
+
+/* room for the text form of each field */
+#define MAC_ADDR_SIZE 18
+#define IP_ADDR_SIZE  20
+#define MTU_SIZE      11
+#define TTL_SIZE      11
+
+/*
+ * A port's configuration as advertised in the CrayTLV. The parsers fill
+ * it in once; validation and every emitter work on these values.
+ */
+typedef struct fabric_config {
+    char *ifname;
+    unsigned int have;
+    uint8_t mac_addr[6];
+    struct in_addr ip_addr;
+    uint8_t prefix;
+    uint32_t mtu;
+    uint32_t ttl;
+    bool org_tlv;           /* a CrayTLV was received, well formed or not */
+} fabric_config_t;
+
+/* the text forms, for logs, ip(8) commands, ifcfg files and JSON */
+struct fabric_config_text {
+    char mac_addr[MAC_ADDR_SIZE];
+    char ip_addr[IP_ADDR_SIZE];
+    char mtu[MTU_SIZE];
+    char ttl[TTL_SIZE];
+};
+
+void fabric_config_clear(fabric_config_t *fc);
+
+void fabric_config_format(const fabric_config_t *fc,
+        struct fabric_config_text *text);
+
+bool fabric_config_equal(const fabric_config_t *a, const fabric_config_t *b);
+
+uint64_t hash_fabric_config(const fabric_config_t *fc);
+
+void mask_mac_addr(uint8_t *mac_addr);
+
+/* longest MAC line the lldptool parser keeps */
+#define LT_MAC_TEXT_SIZE 24
+
+/* incremental parser for 'lldptool get-tlv' output */
+struct lldptool_parser {
+    int state;
+    int next;
+    const char *prefix;
+    size_t pos;
+    uint8_t nibble;
+    bool device_not_up;
+    fabric_config_t *fc;
+    char mac_text[LT_MAC_TEXT_SIZE];
+    char *org_tlv;
+    size_t org_tlv_size;
+};
+
+void lldptool_parser_init(struct lldptool_parser *p, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_size);
+
+void lldptool_parser_feed(struct lldptool_parser *p, const char *buf,
+        size_t len);
+
+void lldptool_parser_finish(struct lldptool_parser *p);
+
+bool craytlv_decode(const char *json, fabric_config_t *fc);
 
 
 #endif /* INCLUDE_TLV_H */
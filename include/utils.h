@@ -29,12 +29,20 @@
 
 #include <stdbool.h>
 
-int hex_to_ascii(const char *cp);
-
 bool run(const char *cmd, bool dry_run);
 
-bool runv(const char **cmdv, bool dry_run);
+/* a command, and the command that undoes it or NULL if nothing can */
+struct run_step {
+    const char *cmd;
+    const char *undo;
+};
+
+bool runv(const struct run_step *steps, bool dry_run);
 
 size_t strlcpy(char *d, const char *s, size_t len);
 
+char **expand_ifnames(int argc, char **argv, int *count);
+
+void free_ifnames(char **ifnames, int count);
+
 #endif /* INCLUDE_UTILS_H */
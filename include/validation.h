@@ -28,18 +28,16 @@
 #define INCLUDE_VALIDATION_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <netinet/in.h>
 
-bool valid_number(const char *str);
+bool parse_u32(const char *str, uint32_t *val);
 
-bool valid_octet(const char **str, int base, char term);
+bool parse_mac_addr(const char *str, uint8_t *mac_addr);
 
-bool valid_mac_addr(const char *mac_addr);
+bool parse_ip_prefix(const char *str, struct in_addr *addr, uint8_t *prefix);
 
-bool valid_ip_addr(const char *ip_addr);
-
-bool valid_mtu(const char *mtu);
-
-bool valid_ttl(const char *ttl);
+bool parse_ttl(const char *str, uint32_t *ttl);
 
 void chomp(char *buf);
 
@@ -34,6 +34,14 @@ Requires: util-linux
 %description -n slingshot-network-config-full
 meta-package for full integration of the component
 
+%package -n slingshot-network-config-devel
+Summary: libslingshot-netcfg headers and libraries
+Requires: slingshot-network-config
+
+%description -n slingshot-network-config-devel
+Header and static and shared libraries for configuring Slingshot HSN
+interfaces from their CrayTLV in process, with libslingshot-netcfg
+
 
 %prep
 %setup -q -n %{name}-%{version}
@@ -54,6 +62,7 @@ for entry in $(ls %{buildroot}%{_pkgdatadir}/%{name}/) ; do
 done
 
 rm -rf ${buildroot}%{_pkgdatadir}/%{name}
+rm -f %{buildroot}%{_libdir}/libslingshot-netcfg.la
 
 %clean
 rm -rf %{buildroot}
@@ -68,7 +77,7 @@ ln -s %{_prefix} ${SH_PREFIX_DEFAULT}
 
 SH_BINDIR=%{_bindir}
 SH_BINDIR_DEFAULT=${SH_BINDIR/%{_build_id}/default}
-ln -sf ${SH_BINDIR_DEFAULT}/slingshot-ifname.sh /usr/bin/slingshot-ifname
+ln -sf ${SH_BINDIR_DEFAULT}/slingshot-ifname /usr/bin/slingshot-ifname
 ln -sf ${SH_BINDIR_DEFAULT}/slingshot-ifroute.sh /usr/bin/slingshot-ifroute
 ln -sf ${SH_BINDIR_DEFAULT}/slingshot-network-cfg-lldp /sbin/slingshot-network-cfg-lldp
 
@@ -141,16 +150,25 @@ fi
 %{_pkgdatadir}/modprobe/99-slingshot-network.conf
 %{_pkgdatadir}/udev/99-slingshot-network.rules
 %{_bindir}/slingshot-ifroute.sh
+%{_bindir}/slingshot-ifroute
 %{_bindir}/slingshot-ifname.sh
+%{_bindir}/slingshot-ifname
 %{_bindir}/slingshot-network-cfg-lldp
 %{_bindir}/stop_lldpad.sh
 %{_bindir}/start_lldpad.sh
 %{_bindir}/run_slingshot_network_cfg_lldp.sh
 %{_bindir}/copy_logfile_to_rootfs.sh
+%{_libdir}/libslingshot-netcfg.so.*
 %doc COPYING
 
 %files -n slingshot-network-config-full
 %defattr(-,root,root,-)
 
+%files -n slingshot-network-config-devel
+%defattr(-,root,root,-)
+%{_includedir}/slingshot-netcfg.h
+%{_libdir}/libslingshot-netcfg.so
+%{_libdir}/libslingshot-netcfg.a
+
 %changelog
 # Mon Aug 17 12:54:52 PDT 2020 S Lester Forked for Slingshot
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* local includes */
+#include "debug.h"
+#include "cfg_lldp.h"
+#include "pool.h"
+#include "tlv.h"
+#include "trace.h"
+
+/* external library includes */
+#include "cJSON.h"
+
+#define BATCH_PATH_SIZE 4096
+
+struct batch_result {
+    struct captured_result base;
+    bool ok;
+};
+
+struct captured_job {
+    char *results;
+    size_t size;
+    captured_fn fn;
+};
+
+struct batch_list {
+    char **paths;
+    int count;
+};
+
+static bool batch_add(struct batch_list *list, const char *path)
+{
+    char **paths;
+
+    paths = realloc(list->paths, (list->count + 1) * sizeof(*paths));
+    if (!paths) {
+        return false;
+    }
+    list->paths = paths;
+
+    paths[list->count] = strdup(path);
+    if (!paths[list->count]) {
+        return false;
+    }
+    list->count++;
+
+    return true;
+}
+
+static int visible_filter(const struct dirent *ent)
+{
+    return ent->d_name[0] != '.';
+}
+
+/* every regular file in a directory, in version order */
+static bool batch_add_dir(struct batch_list *list, const char *dir)
+{
+    char path[BATCH_PATH_SIZE];
+    struct dirent **ents;
+    struct stat st;
+    bool ok = true;
+    int n;
+
+    n = scandir(dir, &ents, visible_filter, versionsort);
+    if (n < 0) {
+        ERROR("Unable to list %s: %s", dir, strerror(errno));
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (ok && snprintf(path, sizeof(path), "%s/%s", dir,
+                    ents[i]->d_name) < (int) sizeof(path) &&
+                !stat(path, &st) && S_ISREG(st.st_mode)) {
+            ok = batch_add(list, path);
+        }
+        free(ents[i]);
+    }
+    free(ents);
+
+    return ok;
+}
+
+/* one path per line, blank lines and '#' comments are skipped */
+static bool batch_add_list(struct batch_list *list, const char *file)
+{
+    char path[BATCH_PATH_SIZE];
+    bool ok = true;
+    FILE *fp;
+
+    fp = fopen(file, "r");
+    if (!fp) {
+        ERROR("Unable to open %s: %s", file, strerror(errno));
+        return false;
+    }
+
+    while (ok && fgets(path, sizeof(path), fp)) {
+        path[strcspn(path, "\r\n")] = '\0';
+        if (path[0] && path[0] != '#') {
+            ok = batch_add(list, path);
+        }
+    }
+
+    fclose(fp);
+
+    return ok;
+}
+
+static void batch_free(struct batch_list *list)
+{
+    for (int i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+}
+
+static void captured_worker(size_t idx, void *arg)
+{
+    struct captured_job *job = arg;
+    struct captured_result *res = (struct captured_result *)
+        (job->results + idx * job->size);
+
+    /* keep the reason for a failure rather than logging it */
+    debug_capture = &res->reason;
+    trace_set_context(res->fc.ifname);
+    job->fn(res);
+    debug_capture = NULL;
+}
+
+/*
+ * Call fn for each of count results, threads at a time. Each result is
+ * size bytes and starts with a struct captured_result naming what it is
+ * for. An error fn would have logged is kept in its reason instead.
+ */
+void run_captured(struct netcfg *nc, void *results, size_t size, int count,
+        int threads, captured_fn fn)
+{
+    struct captured_job job = { results, size, fn };
+    int saved_level;
+
+    for (int i = 0; i < count; i++) {
+        ((struct captured_result *) (job.results + i * size))->nc = nc;
+    }
+
+    /* failures are reported in the results, not on stderr */
+    saved_level = nc->log.level;
+    if (nc->log.level > DEBUG_LVL_VERBOSE) {
+        nc->log.level = DEBUG_LVL_MAX;
+    }
+
+    pool_run(count, threads, captured_worker, &job);
+
+    nc->log.level = saved_level;
+}
+
+static void batch_check(struct captured_result *base)
+{
+    struct batch_result *res = (struct batch_result *) base;
+
+    res->ok = parse_tlv_input(base->nc, &base->fc, base->fc.ifname);
+}
+
+static bool batch_print(const struct batch_result *res)
+{
+    cJSON *obj = cJSON_CreateObject();
+    struct fabric_config_text text;
+    char *line;
+
+    if (!obj) {
+        ERROR("could not allocate a result object");
+        return false;
+    }
+
+    fabric_config_format(&res->base.fc, &text);
+
+    cJSON_AddStringToObject(obj, "file", res->base.fc.ifname);
+    cJSON_AddBoolToObject(obj, "ok", res->ok);
+    cJSON_AddStringToObject(obj, "mac_addr", text.mac_addr);
+    cJSON_AddStringToObject(obj, "ip_addr", text.ip_addr);
+    cJSON_AddStringToObject(obj, "mtu", text.mtu);
+    cJSON_AddStringToObject(obj, "ttl", text.ttl);
+    if (!res->ok) {
+        cJSON_AddStringToObject(obj, "error", res->base.reason.error);
+        cJSON_AddStringToObject(obj, "diag", res->base.reason.diag);
+    }
+
+    line = cJSON_PrintUnformatted(obj);
+    cJSON_Delete(obj);
+    if (!line) {
+        ERROR("could not format a result object");
+        return false;
+    }
+
+    printf("%s\n", line);
+
+    cJSON_free(line);
+
+    return true;
+}
+
+/*
+ * Parse and validate captured lldptool output (or pcaps with -L) offline.
+ * Each input is a dump, a directory of dumps, or @file listing one dump
+ * per line. One JSON object is printed per dump, in input order.
+ */
+int run_batch(struct netcfg *nc, char **inputs, int count)
+{
+    struct batch_list list = { NULL, 0 };
+    struct batch_result *results;
+    struct stat st;
+    long threads;
+    bool ok = true;
+    int valid = 0;
+
+    for (int i = 0; ok && i < count; i++) {
+        if (inputs[i][0] == '@') {
+            ok = batch_add_list(&list, inputs[i] + 1);
+        } else if (!stat(inputs[i], &st) && S_ISDIR(st.st_mode)) {
+            ok = batch_add_dir(&list, inputs[i]);
+        } else {
+            ok = batch_add(&list, inputs[i]);
+        }
+    }
+
+    if (!ok) {
+        batch_free(&list);
+        return EXIT_FAILURE;
+    }
+
+    if (!list.count) {
+        ERROR("no dumps to validate");
+        return EXIT_FAILURE;
+    }
+
+    results = calloc(list.count, sizeof(*results));
+    if (!results) {
+        ERROR("could not allocate batch results");
+        batch_free(&list);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < list.count; i++) {
+        results[i].base.fc.ifname = list.paths[i];
+    }
+
+    threads = nc->options.jobs;
+    if (!threads) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    run_captured(nc, results, sizeof(*results), list.count,
+            threads > 0 ? threads : 1, batch_check);
+
+    for (int i = 0; i < list.count; i++) {
+        /* a result that could not be printed counts as invalid */
+        valid += batch_print(&results[i]) && results[i].ok;
+    }
+
+    VERBOSE("%d of %d dumps valid", valid, list.count);
+
+    free(results);
+    batch_free(&list);
+
+    return valid == list.count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
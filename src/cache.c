@@ -0,0 +1,278 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* local includes */
+#include "cache.h"
+#include "debug.h"
+#include "tlv.h"
+#include "utils.h"
+#include "validation.h"
+
+#define CACHE_MAGIC "slingshot-lldp-config 1"
+
+#define CACHE_KEY_SIZE  64
+#define CACHE_LINE_SIZE 256
+
+/*
+ * The last configuration applied to each port, keyed by the PCI address
+ * of the adapter so it survives interfaces being renamed. Interfaces
+ * without a device are keyed by name.
+ */
+struct cache_entry {
+    char key[CACHE_KEY_SIZE];
+    fabric_config_t fc;     /* without ifname */
+};
+
+static void cache_key(const char *ifname, char *key)
+{
+    char link[PATH_MAX];
+    char target[PATH_MAX];
+    const char *base;
+    ssize_t len;
+
+    snprintf(link, sizeof(link), "/sys/class/net/%s/device", ifname);
+
+    len = readlink(link, target, sizeof(target) - 1);
+    if (len > 0) {
+        target[len] = '\0';
+        base = strrchr(target, '/');
+        strlcpy(key, base ? base + 1 : target, CACHE_KEY_SIZE);
+    } else {
+        strlcpy(key, ifname, CACHE_KEY_SIZE);
+    }
+}
+
+static struct cache_entry *cache_find(struct config_cache *cache,
+        const char *key)
+{
+    for (int i = 0; i < cache->count; i++) {
+        if (!strcmp(cache->entries[i].key, key)) {
+            return &cache->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct cache_entry *cache_add(struct config_cache *cache,
+        const char *key)
+{
+    struct cache_entry *entries;
+
+    entries = realloc(cache->entries, (cache->count + 1) * sizeof(*entries));
+    if (!entries) {
+        ERROR("could not allocate config cache");
+        return NULL;
+    }
+    cache->entries = entries;
+
+    memset(&entries[cache->count], 0, sizeof(*entries));
+    strlcpy(entries[cache->count].key, key, CACHE_KEY_SIZE);
+
+    return &entries[cache->count++];
+}
+
+void config_cache_init(struct config_cache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+    pthread_mutex_init(&cache->lock, NULL);
+}
+
+/* a missing or unreadable cache is an empty one */
+bool config_cache_load(struct config_cache *cache, const char *path)
+{
+    char line[CACHE_LINE_SIZE];
+    char key[CACHE_KEY_SIZE];
+    struct fabric_config_text text;
+    struct cache_entry *entry;
+    fabric_config_t fc;
+    FILE *fp;
+
+    cache->path = strdup(path);
+    if (!cache->path) {
+        ERROR("could not allocate config cache");
+        return false;
+    }
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        DEBUG("no config cache at %s: %s", path, strerror(errno));
+        return true;
+    }
+
+    if (!fgets(line, sizeof(line), fp) || strcmp(line, CACHE_MAGIC "\n")) {
+        WARN("ignoring config cache %s, unknown format", path);
+        fclose(fp);
+        return true;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        memset(&fc, 0, sizeof(fc));
+        if (sscanf(line, "%63s %17s %19s %10s %10s", key, text.mac_addr,
+                    text.ip_addr, text.mtu, text.ttl) != 5 ||
+                !parse_mac_addr(text.mac_addr, fc.mac_addr) ||
+                !parse_ip_prefix(text.ip_addr, &fc.ip_addr, &fc.prefix) ||
+                !parse_u32(text.mtu, &fc.mtu) ||
+                !parse_ttl(text.ttl, &fc.ttl)) {
+            WARN("ignoring malformed config cache line: %s", line);
+            continue;
+        }
+        fc.have = FC_HAVE_ALL;
+
+        entry = cache_find(cache, key);
+        if (!entry) {
+            entry = cache_add(cache, key);
+        }
+        if (!entry) {
+            fclose(fp);
+            return false;
+        }
+        entry->fc = fc;
+    }
+
+    fclose(fp);
+
+    DEBUG("loaded %d cached configs from %s", cache->count, path);
+
+    return true;
+}
+
+void config_cache_free(struct config_cache *cache)
+{
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->count = 0;
+    free(cache->path);
+    cache->path = NULL;
+    pthread_mutex_destroy(&cache->lock);
+}
+
+/* fills in fc from the cache, if its port has been configured before */
+bool config_cache_lookup(struct config_cache *cache, fabric_config_t *fc)
+{
+    struct cache_entry *entry;
+    char key[CACHE_KEY_SIZE];
+    char *ifname = fc->ifname;
+    bool found = false;
+
+    cache_key(ifname, key);
+
+    pthread_mutex_lock(&cache->lock);
+    entry = cache_find(cache, key);
+    if (entry) {
+        *fc = entry->fc;
+        fc->ifname = ifname;
+        found = true;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return found;
+}
+
+/* written whole and renamed into place, so a crash leaves the old cache */
+static void cache_save(struct config_cache *cache)
+{
+    struct fabric_config_text text;
+    char tmp[PATH_MAX];
+    FILE *fp;
+    int fd;
+
+    if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", cache->path) >=
+            (int) sizeof(tmp)) {
+        return;
+    }
+
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        WARN("Unable to create %s, not caching: %s", tmp, strerror(errno));
+        return;
+    }
+
+    fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        unlink(tmp);
+        return;
+    }
+
+    fprintf(fp, "%s\n", CACHE_MAGIC);
+    for (int i = 0; i < cache->count; i++) {
+        fabric_config_format(&cache->entries[i].fc, &text);
+        fprintf(fp, "%s %s %s %s %s\n", cache->entries[i].key, text.mac_addr,
+                text.ip_addr, text.mtu, text.ttl);
+    }
+
+    if (fclose(fp) || rename(tmp, cache->path)) {
+        WARN("Unable to write %s, not caching: %s", cache->path,
+                strerror(errno));
+        unlink(tmp);
+    }
+}
+
+/* remember a configuration that was applied, the file only changes with it */
+void config_cache_store(struct config_cache *cache, const fabric_config_t *fc)
+{
+    struct cache_entry *entry;
+    char key[CACHE_KEY_SIZE];
+
+    if (!cache->path) {
+        return;
+    }
+
+    cache_key(fc->ifname, key);
+
+    pthread_mutex_lock(&cache->lock);
+
+    entry = cache_find(cache, key);
+    if (entry && fabric_config_equal(&entry->fc, fc)) {
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+    if (!entry) {
+        entry = cache_add(cache, key);
+    }
+    if (!entry) {
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+
+    entry->fc = *fc;
+    entry->fc.ifname = NULL;
+
+    VERBOSE("%s: caching config for %s", fc->ifname, key);
+    cache_save(cache);
+
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,1244 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* local includes */
+#include "cache.h"
+#include "clif.h"
+#include "debug.h"
+#include "validation.h"
+#include "utils.h"
+#include "tlv.h"
+#include "lldp.h"
+#include "hostmap.h"
+#include "metrics.h"
+#include "netlink.h"
+#include "pool.h"
+#include "trace.h"
+#include "cfg_lldp.h"
+
+/* external library includes */
+#include "cJSON.h"
+
+/* global definitions */
+#define BUFSIZE       1000
+
+/* room for a rendered ifcfg file, and its permissions */
+#define IFCFG_SIZE    512
+#define IFCFG_MODE    0644
+
+/* the most commands do_ip_cmds() queues */
+#define IP_CMDS_MAX   6
+
+/* how often wait_for_tlv() asks again */
+#define TLV_POLL_MS   1000
+
+/* macros */
+#define ALLOC_CMD_BUFFER(cmds, idx, err_label, fmt, args...) \
+    do { \
+        cmds[idx] = calloc(BUFSIZE, sizeof(char)); \
+        if (!cmds[idx]) { \
+            goto err_label; \
+        } \
+        snprintf(cmds[idx], BUFSIZE * sizeof(char), \
+            fmt, ##args); \
+        idx++; \
+    } while (0)
+
+/* the command that undoes the one ALLOC_CMD_BUFFER() queued last */
+#define ALLOC_UNDO_BUFFER(undos, idx, err_label, fmt, args...) \
+    do { \
+        undos[idx - 1] = calloc(BUFSIZE, sizeof(char)); \
+        if (!undos[idx - 1]) { \
+            goto err_label; \
+        } \
+        snprintf(undos[idx - 1], BUFSIZE * sizeof(char), \
+            fmt, ##args); \
+    } while (0)
+
+/*
+ * lldptool set-lldp -i <ifname> adminStatus=rxtx, retried while lldpad
+ * creates the interface's agent
+ */
+static bool lldptool_set_admin_status(const char *ifname)
+{
+    char cmd[BUFSIZE];
+    struct run_step steps[] = { { cmd, NULL }, { NULL, NULL } };
+
+    snprintf(cmd, sizeof(cmd), "lldptool set-lldp -i %s adminStatus=rxtx",
+            ifname);
+
+    return runv(steps, false);
+}
+
+/*
+ * Connect to lldpad's control interface and have it receive and transmit
+ * LLDP on every interface, so one session serves all of them rather than
+ * one lldptool per query. Falls back to lldptool if lldpad is not there,
+ * or will not take the request.
+ */
+bool lldpad_open(struct netcfg *nc, char **ifnames, int count)
+{
+    const char *sock_name = nc->options.lldpad_socket ?
+            nc->options.lldpad_socket : CLIF_SOCK_NAME;
+    struct trace_span span;
+    bool opened;
+
+    trace_begin(&span, "lldpad_open", NULL);
+
+    opened = clif_open(&nc->lldpad, sock_name, CLIF_TIMEOUT_MS);
+    if (!opened) {
+        WARN("lldpad control interface unavailable, using lldptool");
+        nc->options.lldpad_clif = false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (opened && clif_set_admin_status(&nc->lldpad, ifnames[i], "rxtx")) {
+            continue;
+        }
+        if (!lldptool_set_admin_status(ifnames[i])) {
+            WARN("Unable to set LLDP adminStatus for interface %s",
+                    ifnames[i]);
+        }
+    }
+
+    trace_end(&span);
+
+    return opened;
+}
+
+void lldpad_close(struct netcfg *nc)
+{
+    clif_close(&nc->lldpad);
+}
+
+bool get_lldp_tlv(fabric_config_t *fc, const char *input_file,
+        char *org_tlv, size_t org_tlv_len) {
+    struct lldptool_parser parser;
+    char buf[BUFSIZE];
+    size_t len;
+    FILE *fp;
+
+    snprintf(buf, sizeof(buf), "lldptool get-tlv -i %s -n", fc->ifname);
+
+    if (!input_file) {
+    fp = popen(buf, "r");
+    if (!fp) {
+        ERROR("opening pipe to lldptool failed!");
+        return false;
+    }
+    } else {
+        fp = fopen(input_file, "r");
+        if (!fp) {
+            ERROR("unable to open '%s': %s", input_file, strerror(errno));
+            return false;
+        }
+    }
+
+    lldptool_parser_init(&parser, fc, org_tlv, org_tlv_len);
+
+    /* Process output of lldptool as it arrives */
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        DEBUG("%.*s", (int) len, buf);
+
+        lldptool_parser_feed(&parser, buf, len);
+
+        if (parser.device_not_up) {
+            ERROR("device not found or inactive according to lldp");
+            DIAG("check local adapter state. The adapter may be down");
+            DIAG("carrier signal may also be absent.");
+            pclose(fp);
+            return false;
+        }
+    } /* end while */
+
+    lldptool_parser_finish(&parser);
+
+    if (pclose(fp)) {
+        ERROR("lldptool exited with error status");
+        return false;
+    }
+
+    if (parser.mac_text[0] && !(fc->have & FC_HAVE_MAC)) {
+        ERROR("Invalid MAC addr: '%s'", parser.mac_text);
+        DIAG("MAC address is malformed. Check LLDP output");
+        return false;
+    }
+
+    if (!(fc->have & FC_HAVE_MAC)) {
+        ERROR("lldpad not receiving any data from switch");
+        DIAG("check local LLDPAD configuration for administrative status");
+        DIAG("check Rosetta switch to see if it advertising TLVs on other adapters");
+        return false;
+    }
+
+    if (!org_tlv[0]) {
+        ERROR("Missing Org TLV in lldptool output");
+        DIAG("check Rosetta switch configuration for LLDP. CrayTLV not advertised.");
+        DIAG("Fabric configuration is not active or not advertised");
+        return false;
+    }
+
+    return true;
+}
+
+static bool check_tlv_data(fabric_config_t *fc) {
+    struct fabric_config_text text;
+
+    fabric_config_format(fc, &text);
+
+    VERBOSE("Parsed:");
+    VERBOSE("ifname:   %s", fc->ifname);
+    VERBOSE("mac_addr: %s", text.mac_addr);
+    VERBOSE("ip_addr:  %s", text.ip_addr);
+    VERBOSE("MTU:      %s", text.mtu);
+    VERBOSE("TTL:      %s", text.ttl);
+
+    /* the parsers only fill in values that are well formed */
+    if (!(fc->have & FC_HAVE_MAC)) {
+        ERROR("No MAC addr parsed");
+        DIAG("MAC address is malformed. Check LLDP output");
+        return false;
+    }
+
+    if (!(fc->have & FC_HAVE_IP)) {
+        ERROR("Invalid IP addr: '%s'", text.ip_addr);
+        DIAG("CrayTLV is malformed. Expected a valid IP address");
+        DIAG("Check Rosetta LLDP configuration");
+        return false;
+    }
+
+    if (!(fc->have & FC_HAVE_MTU)) {
+        ERROR("Invalid MTU: '%s'", text.mtu);
+        DIAG("CrayTLV is malformed. Expected a valid MTU");
+        DIAG("Check Rosetta LLDP configuration");
+        return false;
+    }
+
+    if (!(fc->have & FC_HAVE_TTL)) {
+        ERROR("Invalid TTL: '%s'", text.ttl);
+        DIAG("CrayTLV is malformed. Expected a valid TTL");
+        DIAG("Check Rosetta LLDP configuration");
+        return false;
+    }
+
+    return true;
+}
+
+bool is_valid_tlv_data(fabric_config_t *fc)
+{
+    struct trace_span span;
+    bool ret;
+
+    trace_begin(&span, "is_valid_tlv_data", NULL);
+    ret = check_tlv_data(fc);
+    trace_end(&span);
+
+    return ret;
+}
+
+bool parse_tlv(struct netcfg *nc, fabric_config_t *fc)
+{
+    return parse_tlv_input(nc, fc, nc->options.input_file);
+}
+
+static bool parse_tlv_timeout(struct netcfg *nc, fabric_config_t *fc,
+        const char *input_file, int timeout)
+{
+    char org_tlv[LLDP_ORG_TLV_SIZE];
+    struct trace_span span, fetch;
+    bool found, ret = false;
+
+    trace_begin(&span, "parse_tlv", input_file);
+
+    fabric_config_clear(fc);
+
+    VERBOSE("Begin parse_tlv");
+
+    /* fetch TLV from LLDP */
+    org_tlv[0] = '\0';
+    if (nc->options.native_lldp) {
+        trace_begin(&fetch, "lldp_get_tlv", NULL);
+        found = lldp_get_tlv(fc, input_file, timeout,
+                org_tlv, sizeof(org_tlv));
+    } else if (nc->options.lldpad_clif && !input_file) {
+        trace_begin(&fetch, "clif_get_tlv", NULL);
+        found = clif_get_tlv(&nc->lldpad, fc, org_tlv, sizeof(org_tlv));
+    } else {
+        trace_begin(&fetch, "get_lldp_tlv", NULL);
+        found = get_lldp_tlv(fc, input_file, org_tlv, sizeof(org_tlv));
+    }
+    trace_end(&fetch);
+
+    fc->org_tlv = org_tlv[0] != '\0';
+
+    if (!found) {
+        CRITICAL("failed to get response from LLDP, or "
+                    "could not find CrayTLV");
+    } else {
+        trace_begin(&fetch, "decode_tlv", NULL);
+        ret = decode_tlv(fc, org_tlv);
+        trace_end(&fetch);
+    }
+
+    trace_end(&span);
+
+    return ret;
+}
+
+bool parse_tlv_input(struct netcfg *nc, fabric_config_t *fc,
+        const char *input_file)
+{
+    return parse_tlv_timeout(nc, fc, input_file, LLDP_RECV_TIMEOUT);
+}
+
+static long elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) * 1000 +
+        (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/*
+ * Keep asking for the CrayTLV until it is there or options.wait seconds
+ * have passed, so each interface is configured as soon as its switch
+ * advertises. Only the reason for the last failed attempt is logged.
+ */
+bool wait_for_tlv(struct netcfg *nc, fabric_config_t *fc, long *tlv_ms)
+{
+    struct debug_capture quiet, *saved = debug_capture;
+    long deadline_ms = nc->options.wait * 1000L;
+    struct trace_span span;
+    struct timespec start;
+    bool found = false;
+    int timeout;
+    long ms;
+
+    trace_begin(&span, "wait_for_tlv", NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (1) {
+        ms = elapsed_ms(&start);
+        timeout = (deadline_ms - ms + 999) / 1000;
+
+        memset(&quiet, 0, sizeof(quiet));
+        quiet.quiet = true;
+        debug_capture = &quiet;
+        found = parse_tlv_timeout(nc, fc, nc->options.input_file,
+                timeout > 0 ? timeout : 1);
+        debug_capture = saved;
+
+        ms = elapsed_ms(&start);
+        if (found || ms + TLV_POLL_MS > deadline_ms) {
+            break;
+        }
+
+        DEBUG("%s: no CrayTLV yet after %ld ms", fc->ifname, ms);
+        usleep(TLV_POLL_MS * 1000);
+    }
+
+    trace_end(&span);
+
+    if (tlv_ms) {
+        *tlv_ms = ms;
+    }
+
+    if (!found) {
+        ERROR("%s: no CrayTLV within %d seconds", fc->ifname,
+                nc->options.wait);
+        if (quiet.error[0]) {
+            ERROR("%s", quiet.error);
+        }
+        if (quiet.diag[0]) {
+            DIAG("%s", quiet.diag);
+        }
+        return false;
+    }
+
+    VERBOSE("%s: CrayTLV available after %ld ms", fc->ifname, ms);
+
+    return true;
+}
+
+/* a JSON number of at most 32 bits, a fraction is dropped as valueint did */
+static bool json_u32(const cJSON *item, uint32_t *val)
+{
+    double d = item->valuedouble;
+
+    if (!(d >= 0 && d < UINT32_MAX + 1.0)) {
+        return false;
+    }
+
+    *val = d;
+
+    return true;
+}
+
+bool decode_tlv(fabric_config_t *fc, const char *org_tlv)
+{
+    const cJSON *ip_addr_ptr, *mtu_ptr, *ttl_ptr;
+    cJSON *org_json;
+    bool ret = false;
+
+    DEBUG("Org TLV json: '%s'", org_tlv);
+
+    if (craytlv_decode(org_tlv, fc)) {
+        return is_valid_tlv_data(fc);
+    }
+
+    /* not the usual CrayTLV layout, parse JSON payload from Org TLV */
+    DEBUG("Org TLV not in CrayTLV schema, falling back to cJSON");
+    org_json = cJSON_Parse(org_tlv);
+
+    /* read json values from JSON object */
+    ip_addr_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "ip_addr");
+    if (cJSON_IsString(ip_addr_ptr)) {
+        if (!parse_ip_prefix(ip_addr_ptr->valuestring, &fc->ip_addr,
+                    &fc->prefix)) {
+            ERROR("Invalid IP addr: '%s'", ip_addr_ptr->valuestring);
+            DIAG("CrayTLV is malformed. Expected a valid IP address");
+            DIAG("Check Rosetta LLDP configuration");
+            goto delete_json;
+        }
+        fc->have |= FC_HAVE_IP;
+    }
+
+    mtu_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "mtu");
+    if (cJSON_IsNumber(mtu_ptr)) {
+        if (!json_u32(mtu_ptr, &fc->mtu)) {
+            ERROR("Invalid MTU: '%g'", mtu_ptr->valuedouble);
+            DIAG("CrayTLV is malformed. Expected a valid MTU");
+            DIAG("Check Rosetta LLDP configuration");
+            goto delete_json;
+        }
+        fc->have |= FC_HAVE_MTU;
+    }
+
+    ttl_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "ttl");
+    if (cJSON_IsNumber(ttl_ptr) || cJSON_IsString(ttl_ptr)) {
+        if (cJSON_IsNumber(ttl_ptr) ? !json_u32(ttl_ptr, &fc->ttl) :
+                !parse_ttl(ttl_ptr->valuestring, &fc->ttl)) {
+            ERROR("Invalid TTL in CrayTLV");
+            DIAG("CrayTLV is malformed. Expected a valid TTL");
+            DIAG("Check Rosetta LLDP configuration");
+            goto delete_json;
+        }
+        fc->have |= FC_HAVE_TTL;
+    }
+
+    ret = is_valid_tlv_data(fc);
+
+delete_json:
+    cJSON_Delete(org_json);
+
+    return ret;
+}
+
+/* true if file already holds exactly len bytes of content */
+static bool file_matches(const char *file, const char *content, size_t len)
+{
+    char buf[IFCFG_SIZE + 1];
+    size_t n;
+    FILE *fp;
+
+    fp = fopen(file, "r");
+    if (!fp) {
+        return false;
+    }
+
+    n = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    return n == len && !memcmp(buf, content, len);
+}
+
+/* replace file with content so that readers see either the old or new one */
+static bool write_file_atomic(const char *file, const char *content,
+        size_t len)
+{
+    char tmp[BUFSIZE];
+    bool ok;
+    int fd;
+
+    if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", file) >= (int) sizeof(tmp)) {
+        ERROR("ifcfg file name too long: %s", file);
+        return false;
+    }
+
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        ERROR("Unable to create ifcfg file %s: %s", file, strerror(errno));
+        return false;
+    }
+
+    ok = fchmod(fd, IFCFG_MODE) == 0 &&
+        write(fd, content, len) == (ssize_t) len &&
+        fsync(fd) == 0;
+    if (close(fd)) {
+        ok = false;
+    }
+
+    if (!ok || rename(tmp, file)) {
+        ERROR("Unable to write ifcfg file %s: %s", file, strerror(errno));
+        unlink(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Render the ifcfg file for fc and install it if it differs from what is
+ * on disk. changed tells the caller whether wicked needs to reload it.
+ */
+bool write_ifcfg(struct netcfg *nc, fabric_config_t *fc, bool *changed)
+{
+    struct fabric_config_text text;
+    struct trace_span span;
+    char content[IFCFG_SIZE];
+    char file[BUFSIZE];
+    bool ret = true;
+    int len;
+
+    if (!fc) {
+        ERROR("null fc passed to function");
+        return false;
+    }
+
+    fabric_config_format(fc, &text);
+
+    *changed = false;
+
+    trace_begin(&span, "write_ifcfg", NULL);
+
+    snprintf(file, sizeof(file), "/etc/sysconfig/network/ifcfg-%s", fc->ifname);
+
+    /* What to do about ttl? */
+    len = snprintf(content, sizeof(content),
+            "NAME=%s\n"
+            "STARTMODE=auto\n"
+            "BOOTPROTO=static\n"
+            "LLADDR=%s\n"
+            "IPADDR=%s\n"
+            "MTU=%s\n"
+            "POST_UP_SCRIPT=wicked:/etc/sysconfig/network/if-up.d\n",
+            fc->ifname, text.mac_addr, text.ip_addr, text.mtu);
+
+    if (file_matches(file, content, len)) {
+        VERBOSE("'%s' is unchanged", file);
+    } else if (nc->options.dry_run) {
+        VERBOSE("open '%s' for writing", file);
+        fputs(content, stdout);
+        VERBOSE("close");
+        *changed = true;
+    } else {
+        ret = write_file_atomic(file, content, len);
+        *changed = ret;
+    }
+
+    trace_end(&span);
+
+    return ret;
+}
+
+static bool run_wicked(struct netcfg *nc, const char *action,
+        char **ifnames, int count)
+{
+    size_t size = strlen("wicked ") + strlen(action) + 1;
+    size_t len;
+    char *cmd;
+    bool ret;
+
+    for (int i = 0; i < count; i++) {
+        size += strlen(ifnames[i]) + 1;
+    }
+
+    cmd = calloc(size, sizeof(char));
+    if (!cmd) {
+        return false;
+    }
+
+    len = snprintf(cmd, size, "wicked %s", action);
+    for (int i = 0; i < count; i++) {
+        len += snprintf(cmd + len, size - len, " %s", ifnames[i]);
+    }
+
+    ret = run(cmd, nc->options.dry_run);
+
+    free(cmd);
+
+    return ret;
+}
+
+/* cycle the interfaces through wicked so it picks up their ifcfg files */
+bool reload_interfaces(struct netcfg *nc, char **ifnames, int count)
+{
+    struct trace_span span;
+    bool result;
+
+    trace_begin(&span, "reload_interface", NULL);
+
+    result = run_wicked(nc, "ifdown", ifnames, count) &&
+        run_wicked(nc, "ifup", ifnames, count);
+
+    if (!result) {
+        ERROR("a command in the queue failed");
+    }
+
+    trace_end(&span);
+
+    return result;
+}
+
+bool reload_interface(struct netcfg *nc, fabric_config_t *fc)
+{
+    return reload_interfaces(nc, &fc->ifname, 1);
+}
+
+static bool queue_reload(struct netcfg *nc, fabric_config_t *fc)
+{
+    char **queue;
+
+    pthread_mutex_lock(&nc->reload_lock);
+    queue = realloc(nc->reload_queue,
+            (nc->reload_count + 1) * sizeof(*queue));
+    if (queue) {
+        nc->reload_queue = queue;
+        nc->reload_queue[nc->reload_count++] = fc->ifname;
+    }
+    pthread_mutex_unlock(&nc->reload_lock);
+
+    if (!queue) {
+        ERROR("failed to queue reload of %s", fc->ifname);
+    }
+
+    return queue != NULL;
+}
+
+/* reload everything queued so far in one wicked ifdown/ifup cycle */
+bool reload_queued_interfaces(struct netcfg *nc)
+{
+    bool ret = true;
+
+    if (nc->reload_count) {
+        ret = reload_interfaces(nc, nc->reload_queue, nc->reload_count);
+    }
+
+    free(nc->reload_queue);
+    nc->reload_queue = NULL;
+    nc->reload_count = 0;
+
+    return ret;
+}
+
+/*
+ * What do_ip_cmds() has to put back if it gives up. Read over rtnetlink,
+ * which may not be there when ip(8) is standing in for it.
+ */
+static bool ip_link_state_get(const char *ifname, struct nl_link_state *st)
+{
+    struct nl_batch b;
+    bool ret;
+
+    memset(st, 0, sizeof(*st));
+
+    /* as a dry run, so a missing rtnetlink is not an error */
+    if (!nl_batch_init(&b, true)) {
+        return false;
+    }
+
+    ret = nl_link_state_get(&b, if_nametoindex(ifname), st);
+    nl_batch_free(&b);
+
+    return ret;
+}
+
+static void lifetime_text(uint32_t lft, char *buf, size_t size)
+{
+    if (lft == NL_LIFETIME_FOREVER) {
+        snprintf(buf, size, "forever");
+    } else {
+        snprintf(buf, size, "%u", lft);
+    }
+}
+
+/* 'ip addr replace' of the address as it was, lifetimes included */
+static int ip_addr_restore(char *buf, size_t size, const char *ifname,
+        const struct nl_link_state *st, int idx)
+{
+    char addr[INET_ADDRSTRLEN], valid[16], preferred[16];
+
+    inet_ntop(AF_INET, &st->addrs[idx].addr, addr, sizeof(addr));
+    lifetime_text(st->addrs[idx].valid_lft, valid, sizeof(valid));
+    lifetime_text(st->addrs[idx].preferred_lft, preferred, sizeof(preferred));
+
+    return snprintf(buf, size, "ip addr replace %s/%d dev %s "
+            "valid_lft %s preferred_lft %s", addr, st->addrs[idx].prefix,
+            ifname, valid, preferred);
+}
+
+/*
+ * put back the addresses an 'ip addr flush' removed, NULL if there were
+ * none or the command could not be built
+ */
+static char *ip_addrs_restore_cmd(const char *ifname,
+        const struct nl_link_state *st)
+{
+    size_t size = st->naddrs * (BUFSIZE / 4);
+    size_t len = 0;
+    char *cmd;
+
+    if (!st->naddrs) {
+        return NULL;
+    }
+
+    cmd = calloc(size, sizeof(char));
+    if (!cmd) {
+        WARN("%s: could not allocate the command to restore addresses",
+                ifname);
+        return NULL;
+    }
+
+    for (int i = 0; i < st->naddrs && len < size; i++) {
+        if (i) {
+            len += snprintf(cmd + len, size - len, "; ");
+        }
+        if (len < size) {
+            len += ip_addr_restore(cmd + len, size - len, ifname, st, i);
+        }
+    }
+
+    /* a partial list would put back some addresses and not others */
+    if (len >= size) {
+        WARN("%s: too many addresses to restore in one command", ifname);
+        free(cmd);
+        return NULL;
+    }
+
+    return cmd;
+}
+
+/* the address fc wants, if the interface already has it */
+static int ip_addr_find(const fabric_config_t *fc,
+        const struct nl_link_state *st)
+{
+    for (int i = 0; i < st->naddrs; i++) {
+        if (st->addrs[i].addr.s_addr == fc->ip_addr.s_addr &&
+                st->addrs[i].prefix == fc->prefix) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Each command is queued with the command that undoes it, so that runv()
+ * can leave the interface as it found it rather than half configured.
+ */
+bool do_ip_cmds(struct netcfg *nc, fabric_config_t *fc)
+{
+    struct fabric_config_text text, was_text;
+    struct run_step steps[IP_CMDS_MAX + 1] = {};
+    char *commands[IP_CMDS_MAX] = {};
+    char *undo[IP_CMDS_MAX] = {};
+    fabric_config_t was = { .ifname = fc->ifname };
+    struct nl_link_state st;
+    bool known;
+    int addr_idx;
+    int index = 0;
+    bool result = false;
+
+    fabric_config_format(fc, &text);
+
+    known = ip_link_state_get(fc->ifname, &st);
+    if (known) {
+        memcpy(was.mac_addr, st.mac_addr, sizeof(was.mac_addr));
+        was.mtu = st.mtu;
+        was.have = FC_HAVE_MAC | FC_HAVE_MTU;
+    } else if (!nc->options.dry_run) {
+        WARN("%s: current state unknown, a failed apply cannot be undone",
+                fc->ifname);
+    }
+    fabric_config_format(&was, &was_text);
+
+    if (nc->options.remove_ip_addrs) {
+        ALLOC_CMD_BUFFER(commands, index, free_commands,
+                            "ip addr flush dev %s", fc->ifname);
+        if (known) {
+            undo[index - 1] = ip_addrs_restore_cmd(fc->ifname, &st);
+        }
+        /* flushing what could not be put back is not undoable */
+        if (known && st.naddrs && !undo[index - 1]) {
+            ERROR("%s: cannot undo an address flush, not applying",
+                    fc->ifname);
+            goto free_commands;
+        }
+    }
+
+    if (!nc->options.skip_reload) {
+        ALLOC_CMD_BUFFER(commands, index, free_commands,
+                            "ip link set dev %s down", fc->ifname);
+        if (known && st.up) {
+            ALLOC_UNDO_BUFFER(undo, index, free_commands,
+                                "ip link set dev %s up", fc->ifname);
+        }
+    }
+
+    ALLOC_CMD_BUFFER(commands, index, free_commands,
+                        "ip link set dev %s addr %s", fc->ifname, text.mac_addr);
+    if (known) {
+        ALLOC_UNDO_BUFFER(undo, index, free_commands,
+                            "ip link set dev %s addr %s", fc->ifname,
+                            was_text.mac_addr);
+    }
+
+    if (!nc->options.skip_reload) {
+        ALLOC_CMD_BUFFER(commands, index, free_commands,
+                            "ip link set dev %s up", fc->ifname);
+        if (known && !st.up) {
+            ALLOC_UNDO_BUFFER(undo, index, free_commands,
+                                "ip link set dev %s down", fc->ifname);
+        }
+    }
+
+    /* replace, so a retry or an address that is already there succeeds */
+    ALLOC_CMD_BUFFER(commands, index, free_commands,
+                        "ip addr replace %s dev %s valid_lft %s "
+                        "preferred_lft %s", text.ip_addr, fc->ifname,
+                        text.ttl, text.ttl);
+    addr_idx = known ? ip_addr_find(fc, &st) : -1;
+    if (addr_idx >= 0 && !nc->options.remove_ip_addrs) {
+        undo[index - 1] = calloc(BUFSIZE, sizeof(char));
+        if (!undo[index - 1]) {
+            goto free_commands;
+        }
+        ip_addr_restore(undo[index - 1], BUFSIZE, fc->ifname, &st, addr_idx);
+    } else {
+        ALLOC_UNDO_BUFFER(undo, index, free_commands,
+                            "ip addr del %s dev %s", text.ip_addr, fc->ifname);
+    }
+
+    ALLOC_CMD_BUFFER(commands, index, free_commands,
+                        "ip link set dev %s mtu %s", fc->ifname, text.mtu);
+    if (known) {
+        ALLOC_UNDO_BUFFER(undo, index, free_commands,
+                            "ip link set dev %s mtu %s", fc->ifname,
+                            was_text.mtu);
+    }
+
+    for (int i = 0; i < index; i++) {
+        steps[i].cmd = commands[i];
+        steps[i].undo = undo[i];
+    }
+
+    result = runv(steps, nc->options.dry_run);
+
+    if (!result) {
+        ERROR("a command in the queue failed");
+    }
+
+free_commands:
+    for (int i = 0; i < IP_CMDS_MAX; i++) {
+        free(commands[i]);
+        free(undo[i]);
+    }
+
+    return result;
+}
+
+static bool queue_full_apply(struct netcfg *nc, struct nl_batch *b,
+        fabric_config_t *fc, int ifindex)
+{
+    bool ok = true;
+
+    if (nc->options.remove_ip_addrs) {
+        ok = nl_addr_flush(b, ifindex, fc->ifname);
+    }
+
+    if (ok && !nc->options.skip_reload) {
+        ok = nl_link_set_up(b, ifindex, fc->ifname, false);
+    }
+
+    ok = ok && nl_link_set_addr(b, ifindex, fc->ifname, fc->mac_addr);
+
+    if (ok && !nc->options.skip_reload) {
+        ok = nl_link_set_up(b, ifindex, fc->ifname, true);
+    }
+
+    /* the address may already be there, --force applies it regardless */
+    ok = ok && nl_addr_add(b, ifindex, fc->ifname, fc->ip_addr, fc->prefix,
+                fc->ttl, fc->ttl, true);
+    ok = ok && nl_link_set_mtu(b, ifindex, fc->ifname, fc->mtu);
+
+    return ok;
+}
+
+static bool lifetime_needs_refresh(uint32_t current, uint32_t target)
+{
+    if (target == NL_LIFETIME_FOREVER) {
+        return current != NL_LIFETIME_FOREVER;
+    }
+
+    /* the kernel reports what is left, so only refresh once half is gone */
+    return current == NL_LIFETIME_FOREVER || current < target / 2;
+}
+
+/*
+ * Queue only what it takes to get from the kernel's current state to the
+ * target. The link is only cycled when the link-layer address changes.
+ */
+static bool queue_reconcile(struct netcfg *nc, struct nl_batch *b,
+        fabric_config_t *fc, int ifindex, const struct nl_link_state *st)
+{
+    bool mac_changed = memcmp(st->mac_addr, fc->mac_addr, sizeof(fc->mac_addr));
+    bool have_addr = false;
+    bool refresh = false;
+    bool ok = true;
+
+    for (int i = 0; ok && i < st->naddrs; i++) {
+        bool same_addr = st->addrs[i].addr.s_addr == fc->ip_addr.s_addr;
+
+        if (same_addr && st->addrs[i].prefix == fc->prefix) {
+            have_addr = true;
+            refresh = lifetime_needs_refresh(st->addrs[i].valid_lft,
+                    fc->ttl);
+        } else if (same_addr || nc->options.remove_ip_addrs) {
+            ok = nl_addr_del(b, ifindex, fc->ifname,
+                    st->addrs[i].addr, st->addrs[i].prefix);
+        }
+    }
+
+    if (ok && mac_changed) {
+        if (st->up && !nc->options.skip_reload) {
+            ok = nl_link_set_up(b, ifindex, fc->ifname, false);
+        }
+        ok = ok && nl_link_set_addr(b, ifindex, fc->ifname, fc->mac_addr);
+    }
+
+    if (ok && (mac_changed || !st->up) && !nc->options.skip_reload) {
+        ok = nl_link_set_up(b, ifindex, fc->ifname, true);
+    }
+
+    if (ok && (!have_addr || refresh)) {
+        ok = nl_addr_add(b, ifindex, fc->ifname, fc->ip_addr, fc->prefix,
+                fc->ttl, fc->ttl, have_addr);
+    }
+
+    if (ok && st->mtu != fc->mtu) {
+        ok = nl_link_set_mtu(b, ifindex, fc->ifname, fc->mtu);
+    }
+
+    return ok;
+}
+
+/*
+ * Queue on b what it takes to configure fc's interface, which is nothing
+ * if it already matches. With nc->options.force every step is queued.
+ */
+bool plan_netlink_cmds(struct netcfg *nc, fabric_config_t *fc,
+        struct nl_batch *b)
+{
+    struct nl_link_state state;
+    int ifindex;
+    bool ok;
+
+    /* fc has been through is_valid_tlv_data() already */
+    ifindex = if_nametoindex(fc->ifname);
+    if (!ifindex && !nc->options.dry_run) {
+        ERROR("Unable to find interface %s: %s", fc->ifname, strerror(errno));
+        return false;
+    }
+
+    if (!nc->options.force && nl_link_state_get(b, ifindex, &state)) {
+        ok = queue_reconcile(nc, b, fc, ifindex, &state);
+    } else {
+        ok = queue_full_apply(nc, b, fc, ifindex);
+    }
+
+    if (!ok) {
+        ERROR("failed to build netlink requests for %s", fc->ifname);
+    }
+
+    return ok;
+}
+
+bool do_netlink_cmds(struct netcfg *nc, fabric_config_t *fc,
+        const char **status)
+{
+    struct trace_span span;
+    struct nl_batch batch;
+    int failed;
+
+    if (!nl_batch_init(&batch, nc->options.dry_run)) {
+        WARN("rtnetlink unavailable, falling back to ip commands");
+        return do_ip_cmds(nc, fc);
+    }
+
+    if (!plan_netlink_cmds(nc, fc, &batch)) {
+        nl_batch_free(&batch);
+        return false;
+    }
+
+    if (!batch.count) {
+        VERBOSE("%s: already converged, nothing to do", fc->ifname);
+        *status = "already converged";
+        nl_batch_free(&batch);
+        return true;
+    }
+
+    trace_begin(&span, "nl_batch_commit", NULL);
+    failed = nl_batch_commit(&batch);
+    trace_end(&span);
+
+    if (failed) {
+        ERROR("%s: netlink configuration failed", fc->ifname);
+    }
+
+    nl_batch_free(&batch);
+
+    return !failed;
+}
+
+bool apply_config(struct netcfg *nc, fabric_config_t *fc,
+        const char **status)
+{
+    const char *unused;
+    bool changed;
+    bool ret;
+
+    if (!status) {
+        status = &unused;
+    }
+
+    *status = NULL;
+
+    if (nc->options.create_ifcfg) {
+        ret = write_ifcfg(nc, fc, &changed);
+        if (ret && !changed) {
+            *status = "unchanged";
+        } else if (ret && !nc->options.skip_reload) {
+            if (nc->options.defer_reload) {
+                ret = queue_reload(nc, fc);
+                *status = STATUS_RELOAD_QUEUED;
+            } else {
+                ret = reload_interface(nc, fc);
+            }
+        }
+    } else if (nc->options.ip_cmds) {
+        ret = do_ip_cmds(nc, fc);
+    } else {
+        ret = do_netlink_cmds(nc, fc, status);
+    }
+
+    /* the address is in place, so are its neighbours before any job starts */
+    if (ret && nc->options.host_map && !nc->options.create_ifcfg) {
+        ret = host_map_seed(&nc->host_map, fc, nc->options.dry_run);
+    }
+
+    if (!*status) {
+        *status = ret ? "configured" : "apply failed";
+    }
+
+    return ret;
+}
+
+/*
+ * Apply the configuration last applied to this port, so the node is on
+ * the fabric before the switch has advertised. The live CrayTLV still
+ * decides; configure_interface() corrects the port if they differ.
+ */
+static bool apply_cached_config(struct netcfg *nc, fabric_config_t *cached)
+{
+    struct trace_span span;
+    const char *status;
+    bool ret;
+
+    if (!config_cache_lookup(&nc->cache, cached)) {
+        return false;
+    }
+
+    trace_begin(&span, "apply_cached_config", NULL);
+
+    VERBOSE("%s: applying cached config until the CrayTLV arrives",
+            cached->ifname);
+    ret = is_valid_tlv_data(cached) && apply_config(nc, cached, &status);
+    if (!ret) {
+        WARN("%s: could not apply cached config", cached->ifname);
+    }
+
+    trace_end(&span);
+
+    return ret;
+}
+
+static void log_cache_mismatch(const fabric_config_t *cached,
+        const fabric_config_t *fc)
+{
+    struct fabric_config_text was, now;
+
+    fabric_config_format(cached, &was);
+    fabric_config_format(fc, &now);
+
+    WARN("%s: CrayTLV differs from cached config, "
+            "mac %s -> %s, ip %s -> %s, mtu %s -> %s, ttl %s -> %s",
+            fc->ifname, was.mac_addr, now.mac_addr, was.ip_addr,
+            now.ip_addr, was.mtu, now.mtu, was.ttl, now.ttl);
+}
+
+bool configure_interface(struct netcfg *nc, fabric_config_t *fc,
+        const char **status, long *tlv_ms)
+{
+    fabric_config_t cached = { .ifname = fc->ifname };
+    struct trace_span span;
+    struct timespec start;
+    bool early = false;
+    bool found;
+    bool ret;
+
+    trace_begin(&span, "configure_interface", NULL);
+
+    /* an ifcfg would be written and reloaded twice */
+    if (nc->options.config_cache && !nc->options.create_ifcfg) {
+        early = apply_cached_config(nc, &cached);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (nc->options.wait) {
+        found = wait_for_tlv(nc, fc, tlv_ms);
+    } else {
+        found = parse_tlv(nc, fc);
+    }
+    metrics_tlv_fetched(&nc->metrics, fc, found, elapsed_ms(&start));
+
+    if (!found) {
+        CRITICAL("failed to parse TLV provided by LLDP");
+        *status = early ? "cached config, no CrayTLV" : "no valid CrayTLV";
+        ret = false;
+    } else if (early && fabric_config_equal(&cached, fc)) {
+        VERBOSE("%s: CrayTLV confirms cached config", fc->ifname);
+        *status = "cached config confirmed";
+        metrics_confirmed(&nc->metrics, fc->ifname);
+        ret = true;
+    } else {
+        if (early) {
+            log_cache_mismatch(&cached, fc);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ret = apply_config(nc, fc, status);
+        metrics_applied(&nc->metrics, fc->ifname, ret, elapsed_ms(&start));
+    }
+
+    if (ret && nc->options.config_cache && !nc->options.dry_run) {
+        config_cache_store(&nc->cache, fc);
+    }
+
+    trace_end(&span);
+
+    return ret;
+}
+
+struct configure_job {
+    struct netcfg *nc;
+    struct if_result *results;
+};
+
+static void configure_worker(size_t idx, void *arg)
+{
+    struct configure_job *job = arg;
+    struct if_result *res = &job->results[idx];
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    trace_set_context(res->fc.ifname);
+    res->ok = configure_interface(job->nc, &res->fc, &res->status,
+            &res->tlv_ms);
+
+    res->elapsed_ms = elapsed_ms(&start);
+}
+
+static void configure_worker_tagged(size_t idx, void *arg)
+{
+    struct configure_job *job = arg;
+
+    /* tag log lines so interleaved output can be told apart */
+    debug_set_context(job->results[idx].fc.ifname);
+    configure_worker(idx, arg);
+    debug_set_context(NULL);
+}
+
+/*
+ * Configure every interface in results, at most options.jobs at a time.
+ * With more than one, every changed ifcfg is written before they are
+ * all cycled through wicked together.
+ */
+bool configure_interfaces(struct netcfg *nc, struct if_result *results,
+        int count)
+{
+    struct configure_job job = { nc, results };
+    bool defer_reload = nc->options.defer_reload;
+    bool reload_ok;
+    bool ret = true;
+
+    if (count == 1) {
+        configure_worker(0, &job);
+        return results[0].ok;
+    }
+
+    /* only for this pool, later calls on nc reload as they go */
+    nc->options.defer_reload = true;
+    pool_run(count, nc->options.jobs ? nc->options.jobs : count,
+            configure_worker_tagged, &job);
+    nc->options.defer_reload = defer_reload;
+
+    reload_ok = reload_queued_interfaces(nc);
+    for (int i = 0; i < count; i++) {
+        if (results[i].status &&
+                !strcmp(results[i].status, STATUS_RELOAD_QUEUED)) {
+            results[i].ok = reload_ok;
+            results[i].status = reload_ok ? "configured" : "reload failed";
+        }
+        ret = ret && results[i].ok;
+    }
+
+    return ret;
+}
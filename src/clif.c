@@ -0,0 +1,361 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* local includes */
+#include "clif.h"
+#include "debug.h"
+#include "lldp.h"
+#include "tlv.h"
+
+static long now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* parse 'digits' hex digits at *cp, advancing it */
+static bool hex_field(const char **cp, const char *end, int digits,
+        uint32_t *val)
+{
+    char field[9];
+    char *stop;
+
+    if (digits >= (int) sizeof(field) || end - *cp < digits) {
+        return false;
+    }
+
+    memcpy(field, *cp, digits);
+    field[digits] = '\0';
+
+    *val = strtoul(field, &stop, 16);
+    if (*stop) {
+        return false;
+    }
+    *cp += digits;
+
+    return true;
+}
+
+/* lldpad's socket name is abstract, like "\0/com/intel/lldpad" */
+static socklen_t clif_addr(struct sockaddr_un *addr, const char *name)
+{
+    size_t len = strlen(name);
+
+    if (len + 1 > sizeof(addr->sun_path)) {
+        return 0;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path + 1, name, len);
+
+    return offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+bool clif_open(struct clif *c, const char *sock_name, int timeout_ms)
+{
+    struct sockaddr_un addr;
+    sa_family_t family = AF_UNIX;
+    socklen_t addr_len;
+
+    c->fd = -1;
+    c->timeout_ms = timeout_ms;
+
+    addr_len = clif_addr(&addr, sock_name);
+    if (!addr_len) {
+        ERROR("lldpad socket name '%s' is too long", sock_name);
+        return false;
+    }
+
+    c->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) {
+        ERROR("could not open a socket for lldpad: %s", strerror(errno));
+        return false;
+    }
+
+    /* let the kernel pick an abstract name for replies to come back to */
+    if (bind(c->fd, (struct sockaddr *) &family, sizeof(family)) < 0 ||
+            connect(c->fd, (struct sockaddr *) &addr, addr_len) < 0) {
+        ERROR("could not connect to lldpad at '%s': %s", sock_name,
+                strerror(errno));
+        close(c->fd);
+        c->fd = -1;
+        return false;
+    }
+
+    pthread_mutex_init(&c->lock, NULL);
+
+    DEBUG("connected to lldpad at '%s'", sock_name);
+
+    return true;
+}
+
+void clif_close(struct clif *c)
+{
+    if (c->fd < 0) {
+        return;
+    }
+
+    close(c->fd);
+    c->fd = -1;
+    pthread_mutex_destroy(&c->lock);
+}
+
+/*
+ * A response is 'R', a two digit status and, when the request got as far
+ * as a module, the request header echoed back followed by the payload.
+ * Returns false for anything that is not the response to this request.
+ */
+static bool clif_parse_response(const char *msg, size_t len, int cmd,
+        const char *ifname, int *status, const char **payload)
+{
+    const char *cp = msg + 1;
+    const char *end = msg + len;
+    uint32_t val, rsp_status, ifname_len;
+
+    if (len < 3 || msg[0] != CLIF_CMD_RESPONSE ||
+            !hex_field(&cp, end, 2, &rsp_status)) {
+        return false;
+    }
+
+    /* failures may come back without the header */
+    if (cp == end) {
+        *status = rsp_status;
+        *payload = end;
+        return rsp_status != CLIF_STATUS_SUCCESS;
+    }
+
+    if (*cp++ != CLIF_CMD_REQUEST || !hex_field(&cp, end, 1, &val) ||
+            !hex_field(&cp, end, 2, &val) || val != (uint32_t) cmd ||
+            !hex_field(&cp, end, 8, &val) ||
+            !hex_field(&cp, end, 2, &ifname_len) ||
+            end - cp < (long) ifname_len ||
+            ifname_len != strlen(ifname) ||
+            strncmp(cp, ifname, ifname_len)) {
+        return false;
+    }
+    cp += ifname_len;
+
+    if (!hex_field(&cp, end, 2, &val)) {
+        return false;
+    }
+    *status = rsp_status;
+    *payload = cp;
+
+    return true;
+}
+
+/*
+ * Send one request to lldpad and wait for its response. The payload of
+ * the response is copied to payload, if given. Returns the status lldpad
+ * answered with, or -1 if it could not be asked.
+ */
+int clif_request(struct clif *c, int cmd, uint32_t ops, const char *ifname,
+        const char *arg, const char *argval, char *payload, size_t payload_len)
+{
+    char req[CLIF_MSG_SIZE];
+    char rsp[CLIF_MSG_SIZE + 1];
+    struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+    const char *data;
+    int status = -1;
+    size_t len;
+    ssize_t n;
+    long deadline;
+
+    len = snprintf(req, sizeof(req), "%c%08x%c%1x%02x%08x%02zx%s%02x",
+            CLIF_MOD_CMD, CLIF_MOD_MAND, CLIF_CMD_REQUEST, CLIF_MSG_VERSION,
+            cmd, ops, strlen(ifname), ifname, CLIF_NEAREST_BRIDGE);
+    /* as lldptool's render_cmd(), only TLV commands carry a TLV id */
+    if ((cmd == CLIF_CMD_GETTLV || cmd == CLIF_CMD_SETTLV) &&
+            len < sizeof(req)) {
+        len += snprintf(req + len, sizeof(req) - len, "%08x",
+                CLIF_INVALID_TLVID);
+    }
+    if (arg && len < sizeof(req)) {
+        len += snprintf(req + len, sizeof(req) - len, "%02zx%s",
+                strlen(arg), arg);
+    }
+    if (argval && len < sizeof(req)) {
+        len += snprintf(req + len, sizeof(req) - len, "%04zx%s",
+                strlen(argval), argval);
+    }
+    if (len >= sizeof(req)) {
+        ERROR("%s: lldpad request too long", ifname);
+        return -1;
+    }
+
+    DEBUG("lldpad request: %s", req);
+
+    pthread_mutex_lock(&c->lock);
+
+    for (int attempt = 0; status < 0 && attempt < CLIF_RETRIES; attempt++) {
+        if (send(c->fd, req, len, 0) < 0) {
+            ERROR("%s: sending to lldpad failed: %s", ifname, strerror(errno));
+            break;
+        }
+
+        deadline = now_ms() + c->timeout_ms;
+        while (status < 0 && now_ms() < deadline) {
+            if (poll(&pfd, 1, deadline - now_ms()) <= 0) {
+                continue;
+            }
+
+            n = recv(c->fd, rsp, sizeof(rsp) - 1, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ERROR("%s: receiving from lldpad failed: %s", ifname,
+                        strerror(errno));
+                goto unlock;
+            }
+            rsp[n] = '\0';
+
+            /* events and late answers to requests that timed out */
+            if (!clif_parse_response(rsp, n, cmd, ifname, &status, &data)) {
+                DEBUG("%s: ignoring lldpad message: %s", ifname, rsp);
+                continue;
+            }
+
+            DEBUG("lldpad response: %s", rsp);
+
+            if (payload) {
+                snprintf(payload, payload_len, "%s", data);
+            }
+        }
+
+        if (status < 0) {
+            DEBUG("%s: no response from lldpad in %d ms, attempt %d of %d",
+                    ifname, c->timeout_ms, attempt + 1, CLIF_RETRIES);
+        }
+    }
+
+    if (status < 0) {
+        ERROR("%s: lldpad did not respond", ifname);
+    }
+
+unlock:
+    pthread_mutex_unlock(&c->lock);
+
+    return status;
+}
+
+/* lldptool set-lldp -i <ifname> adminStatus=<status> */
+bool clif_set_admin_status(struct clif *c, const char *ifname,
+        const char *status)
+{
+    int ret;
+
+    ret = clif_request(c, CLIF_CMD_SET_LLDP,
+            CLIF_OP_CONFIG | CLIF_OP_ARG | CLIF_OP_ARGVAL, ifname,
+            "adminStatus", status, NULL, 0);
+    if (ret) {
+        if (ret > 0) {
+            VERBOSE("%s: lldpad refused adminStatus=%s, status %d", ifname,
+                    status, ret);
+        }
+        return false;
+    }
+
+    VERBOSE("lldpad: adminStatus set to %s for %s", status, ifname);
+
+    return true;
+}
+
+/* lldptool get-tlv -i <ifname> -n, as the raw TLVs */
+bool clif_get_tlvs(struct clif *c, const char *ifname, uint8_t *tlvs,
+        size_t size, size_t *len)
+{
+    char hex[CLIF_MSG_SIZE];
+    const char *cp = hex;
+    uint32_t byte;
+    int ret;
+
+    *len = 0;
+
+    ret = clif_request(c, CLIF_CMD_GETTLV, CLIF_OP_NEIGHBOR, ifname,
+            NULL, NULL, hex, sizeof(hex));
+    if (ret < 0) {
+        return false;
+    }
+
+    if (ret == CLIF_STATUS_PEER_NOT_PRESENT ||
+            (ret == CLIF_STATUS_SUCCESS && !hex[0])) {
+        ERROR("no LLDPDU received from switch");
+        DIAG("check local adapter state. The adapter may be down");
+        DIAG("check Rosetta switch to see if it advertising TLVs on other adapters");
+        return false;
+    }
+
+    if (ret) {
+        ERROR("lldpad could not get TLVs for %s, status %d", ifname, ret);
+        if (ret == CLIF_STATUS_DEVICE_NOT_FOUND) {
+            DIAG("lldpad has no agent for %s, is the interface up?", ifname);
+        }
+        return false;
+    }
+
+    while (*cp && *len < size) {
+        if (!hex_field(&cp, cp + strlen(cp), 2, &byte)) {
+            ERROR("malformed TLV data from lldpad for %s", ifname);
+            return false;
+        }
+        tlvs[(*len)++] = byte;
+    }
+
+    return true;
+}
+
+bool clif_get_tlv(struct clif *c, fabric_config_t *fc, char *org_tlv,
+        size_t org_tlv_len)
+{
+    uint8_t tlvs[CLIF_MSG_SIZE / 2];
+    size_t len;
+
+    org_tlv[0] = '\0';
+
+    if (!clif_get_tlvs(c, fc->ifname, tlvs, sizeof(tlvs), &len)) {
+        return false;
+    }
+
+    lldp_decode_tlvs(tlvs, len, fc, org_tlv, org_tlv_len);
+
+    return lldp_check_tlv(fc, org_tlv);
+}
@@ -0,0 +1,445 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/rtnetlink.h>
+
+/* local includes */
+#include "cache.h"
+#include "debug.h"
+#include "cfg_lldp.h"
+#include "lldp.h"
+#include "metrics.h"
+#include "netlink.h"
+#include "tlv.h"
+#include "trace.h"
+#include "utils.h"
+
+/* how often to ask lldptool again when LLDPDUs are not received natively */
+#define DAEMON_REFRESH_INTERVAL 30
+
+#define DAEMON_RECV_SIZE 8192
+
+struct watch {
+    struct netcfg *nc;
+    fabric_config_t fc;
+    int ifindex;
+    int fd;
+    bool up;
+    bool have_tlv;
+    bool applied;
+    uint64_t hash;
+    time_t retry_at;
+};
+
+static volatile sig_atomic_t daemon_stop;
+static volatile sig_atomic_t daemon_reload;
+
+static void daemon_signal(int sig)
+{
+    if (sig == SIGHUP) {
+        daemon_reload = 1;
+    } else {
+        daemon_stop = 1;
+    }
+}
+
+static time_t monotonic_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec;
+}
+
+static long elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) * 1000 +
+        (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/* apply fc only if it differs from what was last applied to the interface */
+static void watch_update(struct watch *w)
+{
+    uint64_t hash = hash_fabric_config(&w->fc);
+    struct timespec start;
+
+    if (hash == w->hash && w->applied) {
+        DEBUG("%s: CrayTLV unchanged, nothing to do", w->fc.ifname);
+        return;
+    }
+
+    /*
+     * Applying cycles the link, which brings us straight back here, so
+     * do not retry a config that just failed until the refresh interval
+     * has passed.
+     */
+    if (hash == w->hash && monotonic_now() < w->retry_at) {
+        DEBUG("%s: CrayTLV unchanged since last failure, waiting to retry",
+                w->fc.ifname);
+        return;
+    }
+
+    VERBOSE("%s: CrayTLV %s, applying configuration", w->fc.ifname,
+            w->applied ? "changed" : "received");
+
+    w->hash = hash;
+    trace_set_context(w->fc.ifname);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    w->applied = apply_config(w->nc, &w->fc, NULL);
+    metrics_applied(&w->nc->metrics, w->fc.ifname, w->applied,
+            elapsed_ms(&start));
+
+    if (!w->applied) {
+        ERROR("%s: failed to apply configuration", w->fc.ifname);
+        w->retry_at = monotonic_now() + DAEMON_REFRESH_INTERVAL;
+    } else if (!w->nc->options.dry_run) {
+        config_cache_store(&w->nc->cache, &w->fc);
+    }
+}
+
+static void watch_refresh(struct watch *w)
+{
+    struct timespec start;
+    bool found;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    found = parse_tlv(w->nc, &w->fc);
+    metrics_tlv_fetched(&w->nc->metrics, &w->fc, found,
+            elapsed_ms(&start));
+
+    if (!found) {
+        WARN("%s: no valid CrayTLV available yet", w->fc.ifname);
+        return;
+    }
+
+    watch_update(w);
+}
+
+static void watch_recv(struct watch *w)
+{
+    uint8_t frame[DAEMON_RECV_SIZE];
+    char org_tlv[LLDP_ORG_TLV_SIZE] = "";
+    fabric_config_t fc = { .ifname = w->fc.ifname };
+    ssize_t len;
+
+    len = recv(w->fd, frame, sizeof(frame), MSG_DONTWAIT);
+    if (len < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            ERROR("%s: recv on LLDP socket failed: %s",
+                    w->fc.ifname, strerror(errno));
+        }
+        return;
+    }
+
+    /* w->fc keeps the last good CrayTLV, for SIGHUP to apply again */
+    if (!lldp_decode_frame(frame, len, &fc, org_tlv, sizeof(org_tlv))) {
+        return;
+    }
+
+    fc.org_tlv = org_tlv[0] != '\0';
+
+    if (!(fc.have & FC_HAVE_MAC) || !org_tlv[0]) {
+        WARN("%s: LLDPDU without MAC address or CrayTLV", fc.ifname);
+        metrics_tlv_fetched(&w->nc->metrics, &fc, false, -1);
+        return;
+    }
+
+    /* the frame was pushed to us, there is no fetch to time */
+    if (decode_tlv(&fc, org_tlv)) {
+        metrics_tlv_fetched(&w->nc->metrics, &fc, true, -1);
+        w->fc = fc;
+        w->have_tlv = true;
+        watch_update(w);
+    } else {
+        metrics_tlv_fetched(&w->nc->metrics, &fc, false, -1);
+    }
+}
+
+static void watch_open(struct watch *w)
+{
+    if (!w->nc->options.native_lldp || w->fd >= 0) {
+        return;
+    }
+
+    w->fd = lldp_open(w->fc.ifname);
+}
+
+static void watch_close(struct watch *w)
+{
+    if (w->fd >= 0) {
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+/* up as the link events below see it, administratively and with carrier */
+static bool link_is_up(const char *ifname)
+{
+    struct ifreq ifr = { };
+    bool up = false;
+    int fd;
+
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    strlcpy(ifr.ifr_name, ifname, sizeof(ifr.ifr_name));
+    if (!ioctl(fd, SIOCGIFFLAGS, &ifr)) {
+        up = (ifr.ifr_flags & IFF_UP) && (ifr.ifr_flags & IFF_RUNNING);
+    }
+
+    close(fd);
+
+    return up;
+}
+
+static void handle_link_msg(struct watch *watches, int count,
+        const struct nlmsghdr *n)
+{
+    const struct ifinfomsg *ifi = NLMSG_DATA(n);
+    const struct rtattr *rta = IFLA_RTA(ifi);
+    int len = IFLA_PAYLOAD(n);
+    const char *ifname = NULL;
+    struct watch *w = NULL;
+    bool up;
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            ifname = RTA_DATA(rta);
+        }
+    }
+
+    for (int i = 0; ifname && i < count; i++) {
+        if (!strcmp(watches[i].fc.ifname, ifname)) {
+            w = &watches[i];
+        }
+    }
+
+    if (!w) {
+        return;
+    }
+
+    if (n->nlmsg_type == RTM_DELLINK) {
+        VERBOSE("%s: interface removed", ifname);
+        watch_close(w);
+        w->ifindex = 0;
+        w->up = false;
+        w->have_tlv = false;
+        w->applied = false;
+        return;
+    }
+
+    /* a renamed or re-created device needs a fresh LLDP socket */
+    if (w->ifindex != ifi->ifi_index) {
+        watch_close(w);
+        w->ifindex = ifi->ifi_index;
+    }
+
+    up = (ifi->ifi_flags & IFF_UP) && (ifi->ifi_flags & IFF_RUNNING);
+    if (up == w->up) {
+        return;
+    }
+
+    w->up = up;
+    VERBOSE("%s: link %s", ifname, up ? "up" : "down");
+
+    if (up) {
+        watch_open(w);
+        if (!w->nc->options.native_lldp) {
+            watch_refresh(w);
+        }
+    }
+}
+
+static void handle_link_events(struct watch *watches, int count, int fd)
+{
+    char buf[DAEMON_RECV_SIZE];
+    struct nlmsghdr *n;
+    ssize_t len;
+
+    len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (len < 0) {
+        if (errno == ENOBUFS) {
+            WARN("link events were dropped, rechecking every interface");
+            daemon_reload = 1;
+        } else if (errno != EAGAIN && errno != EINTR) {
+            ERROR("rtnetlink receive failed: %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (n = (struct nlmsghdr *) buf; NLMSG_OK(n, len);
+            n = NLMSG_NEXT(n, len)) {
+        if (n->nlmsg_type == RTM_NEWLINK || n->nlmsg_type == RTM_DELLINK) {
+            handle_link_msg(watches, count, n);
+        }
+    }
+}
+
+/*
+ * Stay resident, configuring each interface whenever a link comes up or
+ * a new LLDPDU arrives. Configuration is only (re)applied when the
+ * decoded CrayTLV differs from what was applied last. SIGHUP forces
+ * everything to be applied again, SIGTERM/SIGINT exit.
+ */
+int run_daemon(struct netcfg *nc, char **ifnames, int count)
+{
+    struct sigaction sa = { .sa_handler = daemon_signal };
+    struct watch *watches;
+    struct pollfd *pfds;
+    time_t next_refresh = 0;
+    int nl_fd;
+
+    watches = calloc(count, sizeof(*watches));
+    pfds = calloc(count + 1, sizeof(*pfds));
+    if (!watches || !pfds) {
+        ERROR("could not allocate daemon state");
+        goto free_state;
+    }
+
+    nl_fd = nl_monitor_open(RTMGRP_LINK);
+    if (nl_fd < 0) {
+        ERROR("unable to watch for link events");
+        goto free_state;
+    }
+
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+
+    for (int i = 0; i < count; i++) {
+        watches[i].nc = nc;
+        watches[i].fc.ifname = ifnames[i];
+        watches[i].ifindex = if_nametoindex(ifnames[i]);
+        watches[i].fd = -1;
+        watches[i].up = watches[i].ifindex && link_is_up(ifnames[i]);
+        if (watches[i].up) {
+            watch_open(&watches[i]);
+        }
+    }
+
+    VERBOSE("daemon started, watching %d interface(s)", count);
+
+    while (!daemon_stop) {
+        struct timespec now;
+        int nfds = 0;
+        int timeout = -1;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        if (daemon_reload) {
+            daemon_reload = 0;
+            VERBOSE("reapplying configuration on every interface");
+            for (int i = 0; i < count; i++) {
+                watches[i].applied = false;
+                watches[i].retry_at = 0;
+
+                /* LLDPDUs only come every 30s or so, use the last one */
+                if (nc->options.native_lldp && watches[i].up &&
+                        watches[i].have_tlv) {
+                    watch_update(&watches[i]);
+                }
+            }
+            next_refresh = 0;
+        }
+
+        if (!nc->options.native_lldp) {
+            if (now.tv_sec >= next_refresh) {
+                for (int i = 0; i < count; i++) {
+                    if (watches[i].up) {
+                        watch_refresh(&watches[i]);
+                    }
+                }
+                next_refresh = now.tv_sec + DAEMON_REFRESH_INTERVAL;
+            }
+            timeout = (next_refresh - now.tv_sec) * 1000;
+        }
+
+        pfds[nfds].fd = nl_fd;
+        pfds[nfds++].events = POLLIN;
+        for (int i = 0; i < count; i++) {
+            pfds[nfds].fd = watches[i].fd;
+            pfds[nfds++].events = POLLIN;
+        }
+
+        /* log lines are buffered, get them out before going idle */
+        debug_flush();
+        metrics_flush(&nc->metrics);
+
+        if (poll(pfds, nfds, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR("poll failed: %s", strerror(errno));
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            handle_link_events(watches, count, nl_fd);
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (watches[i].fd >= 0 && (pfds[i + 1].revents & POLLIN)) {
+                watch_recv(&watches[i]);
+            }
+        }
+    }
+
+    VERBOSE("daemon exiting");
+
+    for (int i = 0; i < count; i++) {
+        watch_close(&watches[i]);
+    }
+    close(nl_fd);
+    free(pfds);
+    free(watches);
+
+    return daemon_stop ? EXIT_SUCCESS : EXIT_FAILURE;
+
+free_state:
+    free(pfds);
+    free(watches);
+
+    return EXIT_FAILURE;
+}
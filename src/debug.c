@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "debug.h"
 
@@ -41,30 +42,211 @@ char *log_level_labels[DEBUG_LVL_MAX] = {
 	[DEBUG_LVL_FATAL] = "FATAL",
 };
 
-int debug_level = DEBUG_LVL_ERROR;
+struct debug_sink debug_default_sink = {
+	.level = DEBUG_LVL_ERROR,
+	.format = DEBUG_FORMAT_TEXT,
+};
+
+/* the sink for whatever this thread is doing, e.g. a library call */
+__thread struct debug_sink *debug_sink = &debug_default_sink;
+
+/* tag for messages from this thread, e.g. the interface being configured */
+__thread char debug_context[32];
+
+void debug_set_context(const char *context)
+{
+	if (context) {
+		snprintf(debug_context, sizeof(debug_context), "%s", context);
+	} else {
+		debug_context[0] = '\0';
+	}
+}
+
+/* set by threads that want to report failures themselves */
+__thread struct debug_capture *debug_capture;
+
+void debug_capture_msg(int dbg_lvl, const char *fmt, ...)
+{
+	char *buf;
+	va_list ap;
+
+	if (dbg_lvl == DEBUG_LVL_ERROR) {
+		buf = debug_capture->error;
+	} else if (dbg_lvl == DEBUG_LVL_DIAG) {
+		buf = debug_capture->diag;
+	} else {
+		return;
+	}
+
+	if (buf[0]) {
+		return;
+	}
+
+	va_start(ap, fmt);
+	vsnprintf(buf, DEBUG_CAPTURE_SIZE, fmt, ap);
+	va_end(ap);
+}
+
+/*
+ * Log lines are collected here and written out when the buffer fills,
+ * when something at ERROR or above is logged, on debug_flush() and at
+ * exit, instead of flushing every line.
+ */
+#define LOG_BUF_SIZE  65536
+#define LOG_LINE_SIZE 1024
+
+static char log_buf[LOG_BUF_SIZE];
+static size_t log_len;
+static FILE *log_fp;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+
+/* the timestamp only changes once a second, so keep it per thread */
+static __thread time_t log_ts_sec = -1;
+static __thread char log_ts[64];
+
+static void log_flush_locked(void)
+{
+	if (log_len && log_fp) {
+		fwrite(log_buf, 1, log_len, log_fp);
+		fflush(log_fp);
+	}
+	log_len = 0;
+}
+
+void debug_flush(void)
+{
+	pthread_mutex_lock(&log_lock);
+	log_flush_locked();
+	pthread_mutex_unlock(&log_lock);
+}
+
+static void log_init(void)
+{
+	atexit(debug_flush);
+}
+
+static const char *log_timestamp(void)
+{
+	time_t t = time(NULL);
+	struct tm tm;
 
-void debug_fprintf(const char *file, const char *func, const int line, FILE* fp, char *fmt, ...) {
-	char buf[1024];
-	char *buf_ptr;
-	int bc = 0;
+	if (t != log_ts_sec) {
+		localtime_r(&t, &tm);
+		strftime(log_ts, sizeof(log_ts), "%Y/%m/%d %H:%M:%S %Z", &tm);
+		log_ts_sec = t;
+	}
+
+	return log_ts;
+}
+
+/* append to line, clamping at its end */
+static void line_printf(char *line, size_t *len, const char *fmt, ...)
+	__attribute__((format(printf, 3, 4)));
+
+static void line_vprintf(char *line, size_t *len, const char *fmt, va_list ap)
+{
+	int n;
+
+	if (*len >= LOG_LINE_SIZE - 1) {
+		return;
+	}
+
+	n = vsnprintf(line + *len, LOG_LINE_SIZE - 1 - *len, fmt, ap);
+	if (n > 0) {
+		*len += n;
+		if (*len > LOG_LINE_SIZE - 2) {
+			*len = LOG_LINE_SIZE - 2;
+		}
+	}
+}
+
+static void line_printf(char *line, size_t *len, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	line_vprintf(line, len, fmt, ap);
+	va_end(ap);
+}
+
+static void line_json_string(char *line, size_t *len, const char *str)
+{
+	line_printf(line, len, "\"");
+	for (; *str && *len < LOG_LINE_SIZE - 8; str++) {
+		unsigned char c = *str;
+
+		if (c == '"' || c == '\\') {
+			line[(*len)++] = '\\';
+			line[(*len)++] = c;
+		} else if (c < ' ') {
+			*len += sprintf(line + *len, "\\u%04x", c);
+		} else {
+			line[(*len)++] = c;
+		}
+	}
+	line[*len] = '\0';
+	line_printf(line, len, "\"");
+}
+
+void debug_log(const char *file, const char *func, const int line, FILE *fp,
+		int dbg_lvl, const char *fmt, ...)
+{
+	char buf[LOG_LINE_SIZE];
+	char msg[LOG_LINE_SIZE];
+	size_t len = 0;
+	int off = 0;
 	va_list ap;
-	time_t t;
-	struct tm *tmp;
 
+	pthread_once(&log_once, log_init);
 
-	t = time(NULL);
-	tmp = localtime(&t);
-	buf_ptr = buf + strftime(buf, sizeof(buf), "%Y/%m/%d %H:%M:%S %Z ", tmp);
+	/* the callback has no other way to tell interfaces apart */
+	if (debug_sink->fn && debug_context[0]) {
+		off = snprintf(msg, sizeof(msg), "%s: ", debug_context);
+	}
 
 	va_start(ap, fmt);
-	buf_ptr += vsprintf(buf_ptr, fmt, ap);
+	vsnprintf(msg + off, sizeof(msg) - off, fmt, ap);
 	va_end(ap);
 
-	bc = sprintf(buf_ptr, " - [%s:%s():%d]", file, func, line);
-	if (bc < 0) {
-	    fprintf(stderr, "could not print debug to stderr, ret=%d\n", bc);
+	if (debug_sink->fn) {
+		debug_sink->fn(debug_sink->arg, dbg_lvl, msg);
+		return;
+	}
+
+	if (debug_sink->format == DEBUG_FORMAT_JSON) {
+		line_printf(buf, &len, "{\"time\":\"%s\",\"level\":\"%s\",",
+				log_timestamp(), log_level_labels[dbg_lvl]);
+		if (debug_context[0]) {
+			line_printf(buf, &len, "\"context\":");
+			line_json_string(buf, &len, debug_context);
+			line_printf(buf, &len, ",");
+		}
+		line_printf(buf, &len, "\"message\":");
+		line_json_string(buf, &len, msg);
+		line_printf(buf, &len, ",\"file\":\"%s\",\"func\":\"%s\",\"line\":%d}",
+				file, func, line);
+	} else {
+		line_printf(buf, &len, "%s [%s] - %s%s%s - [%s:%s():%d]",
+				log_timestamp(), log_level_labels[dbg_lvl],
+				debug_context, debug_context[0] ? ": " : "", msg,
+				file, func, line);
+	}
+	buf[len++] = '\n';
+
+	pthread_mutex_lock(&log_lock);
+
+	if (fp != log_fp || log_len + len > sizeof(log_buf)) {
+		log_flush_locked();
+		log_fp = fp;
+	}
+
+	memcpy(log_buf + log_len, buf, len);
+	log_len += len;
+
+	if (dbg_lvl >= DEBUG_LVL_ERROR) {
+		log_flush_locked();
 	}
-	fprintf(fp, "%s\n", buf);
 
-	fflush(fp);
+	pthread_mutex_unlock(&log_lock);
 }
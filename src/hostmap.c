@@ -0,0 +1,315 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/neighbour.h>
+
+/* local includes */
+#include "debug.h"
+#include "hostmap.h"
+#include "netlink.h"
+#include "trace.h"
+#include "utils.h"
+#include "validation.h"
+
+#define HOST_MAP_LINE_SIZE 256
+
+struct host_entry {
+    uint32_t addr;      /* host byte order, so entries sort by address */
+    uint8_t mac_addr[6];
+    bool derived;
+};
+
+static struct host_entry *host_map_grow(struct host_map *map)
+{
+    struct host_entry *entries;
+    int size;
+
+    if (map->count == map->size) {
+        size = map->size ? map->size * 2 : 256;
+        entries = realloc(map->entries, size * sizeof(*entries));
+        if (!entries) {
+            ERROR("could not allocate host map");
+            return NULL;
+        }
+        map->entries = entries;
+        map->size = size;
+    }
+
+    return &map->entries[map->count++];
+}
+
+/*
+ * Every host address in the subnet gets the base MAC address with the
+ * host bits of its IP address in the low octets. The second octet is
+ * then masked off, the same as mask_mac_addr() does for the address
+ * the switch advertises.
+ */
+static bool host_map_derive(struct host_map *map, const char *subnet,
+        const char *base, const char *path, int lineno)
+{
+    char addr_str[INET_ADDRSTRLEN];
+    uint8_t base_mac[6];
+    struct in_addr addr;
+    uint32_t net, host_bits;
+    int prefix, len = 0;
+
+    if (sscanf(subnet, "%15[0-9.]/%d%n", addr_str, &prefix, &len) != 2 ||
+            subnet[len] || inet_pton(AF_INET, addr_str, &addr) != 1 ||
+            prefix < 0 || prefix > 30) {
+        ERROR("%s:%d: invalid subnet '%s'", path, lineno, subnet);
+        return false;
+    }
+    if (prefix < HOST_MAP_MIN_DERIVE_PREFIX) {
+        ERROR("%s:%d: subnet '%s' is larger than /%d", path, lineno, subnet,
+                HOST_MAP_MIN_DERIVE_PREFIX);
+        return false;
+    }
+    if (!parse_mac_addr(base, base_mac)) {
+        ERROR("%s:%d: invalid MAC address '%s'", path, lineno, base);
+        return false;
+    }
+
+    host_bits = (1U << (32 - prefix)) - 1;
+    net = ntohl(addr.s_addr) & ~host_bits;
+
+    /* skip the network and broadcast addresses */
+    for (uint32_t host = 1; host < host_bits; host++) {
+        struct host_entry *e = host_map_grow(map);
+        uint32_t bits = host;
+
+        if (!e) {
+            return false;
+        }
+        e->addr = net | host;
+        e->derived = true;
+        memcpy(e->mac_addr, base_mac, sizeof(e->mac_addr));
+        for (int i = 5; i >= 0 && bits; i--, bits >>= 8) {
+            e->mac_addr[i] |= bits & 0xff;
+        }
+        e->mac_addr[1] = 0;
+    }
+
+    return true;
+}
+
+static int host_entry_cmp(const void *a, const void *b)
+{
+    const struct host_entry *x = a, *y = b;
+
+    if (x->addr != y->addr) {
+        return x->addr < y->addr ? -1 : 1;
+    }
+
+    /* explicit entries first, they win over derived ones */
+    return x->derived - y->derived;
+}
+
+/*
+ * permanent by default, slingshot-ifroute flushes dynamic neighbours on the
+ * interface after it comes up and would take the seeded entries with them
+ */
+void host_map_init(struct host_map *map)
+{
+    memset(map, 0, sizeof(*map));
+    map->state = NUD_PERMANENT;
+}
+
+/*
+ * Load a host map. Each line is one of
+ *
+ *   <ip> <mac>                  a single host
+ *   derive <ip>/<prefix> <mac>  every host in a subnet, see host_map_derive()
+ *   nud permanent|reachable     the state entries are installed with,
+ *                               permanent unless set
+ *
+ * Blank lines and '#' comments are ignored.
+ */
+bool host_map_load(struct host_map *map, const char *path)
+{
+    char line[HOST_MAP_LINE_SIZE];
+    char key[HOST_MAP_LINE_SIZE], arg[HOST_MAP_LINE_SIZE];
+    char extra[HOST_MAP_LINE_SIZE];
+    struct in_addr addr;
+    int lineno = 0, n, fields;
+    bool ok = true;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        ERROR("Unable to open host map %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    while (ok && fgets(line, sizeof(line), fp)) {
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        fields = sscanf(line, "%255s %255s %255s", key, arg, extra);
+        if (fields <= 0) {
+            continue;
+        }
+
+        if (!strcmp(key, "derive") && fields == 3) {
+            ok = host_map_derive(map, arg, extra, path, lineno);
+        } else if (!strcmp(key, "nud") && fields == 2 &&
+                !strcmp(arg, "permanent")) {
+            map->state = NUD_PERMANENT;
+        } else if (!strcmp(key, "nud") && fields == 2 &&
+                !strcmp(arg, "reachable")) {
+            map->state = NUD_REACHABLE;
+        } else if (fields == 2 && inet_pton(AF_INET, key, &addr) == 1) {
+            struct host_entry *e = host_map_grow(map);
+
+            if (!e) {
+                ok = false;
+                break;
+            }
+            e->addr = ntohl(addr.s_addr);
+            e->derived = false;
+            if (!parse_mac_addr(arg, e->mac_addr)) {
+                ERROR("%s:%d: invalid MAC address '%s'", path, lineno, arg);
+                ok = false;
+            }
+        } else {
+            ERROR("%s:%d: invalid host map entry", path, lineno);
+            ok = false;
+        }
+    }
+
+    fclose(fp);
+
+    if (!ok) {
+        host_map_free(map);
+        return false;
+    }
+
+    qsort(map->entries, map->count, sizeof(*map->entries), host_entry_cmp);
+
+    /* drop all but the first entry for each address */
+    n = 0;
+    for (int i = 0; i < map->count; i++) {
+        if (!n || map->entries[i].addr != map->entries[n - 1].addr) {
+            map->entries[n++] = map->entries[i];
+        }
+    }
+    map->count = n;
+
+    VERBOSE("%d hosts in host map %s", map->count, path);
+
+    return true;
+}
+
+void host_map_free(struct host_map *map)
+{
+    free(map->entries);
+    map->entries = NULL;
+    map->count = 0;
+    map->size = 0;
+}
+
+/* index of the first entry at or above addr */
+static int host_map_lower_bound(const struct host_map *map, uint32_t addr)
+{
+    int lo = 0, hi = map->count;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (map->entries[mid].addr < addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*
+ * Install a neighbour entry for every host map entry in the subnet of
+ * the interface's new address, as one netlink batch.
+ */
+bool host_map_seed(const struct host_map *map, const fabric_config_t *fc,
+        bool dry_run)
+{
+    struct trace_span span;
+    struct nl_batch batch;
+    struct in_addr addr;
+    uint32_t self, net, host_bits;
+    int ifindex, prefix = fc->prefix, failed;
+    bool ok = true;
+
+    ifindex = if_nametoindex(fc->ifname);
+    if (!ifindex && !dry_run) {
+        ERROR("Unable to find interface %s: %s", fc->ifname, strerror(errno));
+        return false;
+    }
+
+    self = ntohl(fc->ip_addr.s_addr);
+    host_bits = prefix ? (1ULL << (32 - prefix)) - 1 : ~0U;
+    net = self & ~host_bits;
+
+    if (!nl_batch_init(&batch, dry_run)) {
+        return false;
+    }
+
+    for (int i = host_map_lower_bound(map, net); ok && i < map->count &&
+            map->entries[i].addr <= (net | host_bits); i++) {
+        if (map->entries[i].addr == self) {
+            continue;
+        }
+
+        addr.s_addr = htonl(map->entries[i].addr);
+        ok = nl_neigh_replace(&batch, ifindex, fc->ifname, addr,
+                map->entries[i].mac_addr, map->state);
+    }
+
+    if (!ok) {
+        ERROR("failed to build neighbour requests for %s", fc->ifname);
+        nl_batch_free(&batch);
+        return false;
+    }
+
+    trace_begin(&span, "host_map_seed", NULL);
+    VERBOSE("%s: seeding %d neighbour entries", fc->ifname, batch.count);
+    failed = nl_batch_commit(&batch);
+    trace_end(&span);
+
+    if (failed) {
+        ERROR("%s: neighbour seeding failed", fc->ifname);
+    }
+
+    nl_batch_free(&batch);
+
+    return !failed;
+}
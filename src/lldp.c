@@ -0,0 +1,392 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+/* local includes */
+#include "debug.h"
+#include "lldp.h"
+#include "tlv.h"
+
+#define LLDP_FRAME_SIZE 2048
+
+#define LLDP_TLV_END        0
+#define LLDP_TLV_CHASSIS_ID 1
+#define LLDP_TLV_PORT_ID    2
+#define LLDP_TLV_ORG        127
+
+#define LLDP_CHASSIS_ID_MAC 4
+#define LLDP_PORT_ID_MAC    3
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+#define PCAP_LINKTYPE_ETHER 1
+
+struct pcap_file_header {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct pcap_record_header {
+    uint32_t ts_sec;
+    uint32_t ts_frac;
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+/* nearest bridge group address, where switches send their LLDPDUs */
+static const uint8_t lldp_mcast_addr[ETH_ALEN] = {
+    0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e
+};
+
+static void set_mac_addr(fabric_config_t *fc, const uint8_t *octets)
+{
+    memcpy(fc->mac_addr, octets, ETH_ALEN);
+    mask_mac_addr(fc->mac_addr);
+    fc->have |= FC_HAVE_MAC;
+}
+
+/* the TLVs of an LLDPDU, without the ethernet header */
+void lldp_decode_tlvs(const uint8_t *tlvs, size_t len, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_len)
+{
+    const uint8_t *cp = tlvs;
+    const uint8_t *end = tlvs + len;
+
+    while (cp + 2 <= end) {
+        int type = cp[0] >> 1;
+        size_t length = ((cp[0] & 0x1) << 8) | cp[1];
+        const uint8_t *value = cp + 2;
+
+        if (value + length > end) {
+            DEBUG("truncated TLV, type=%d length=%zu", type, length);
+            break;
+        }
+
+        DEBUG("TLV type=%d length=%zu", type, length);
+
+        switch (type) {
+            case LLDP_TLV_END:
+                return;
+            case LLDP_TLV_CHASSIS_ID:
+            case LLDP_TLV_PORT_ID:
+                /* same source as the first '\tMAC: ' line of lldptool */
+                if ((fc->have & FC_HAVE_MAC) || length != ETH_ALEN + 1) {
+                    break;
+                }
+                if ((type == LLDP_TLV_CHASSIS_ID &&
+                            value[0] == LLDP_CHASSIS_ID_MAC) ||
+                        (type == LLDP_TLV_PORT_ID &&
+                            value[0] == LLDP_PORT_ID_MAC)) {
+                    set_mac_addr(fc, value + 1);
+                }
+                break;
+            case LLDP_TLV_ORG:
+                if (org_tlv[0] || length < 4) {
+                    break;
+                }
+                if (((value[0] << 16) | (value[1] << 8) | value[2]) ==
+                            LLDP_CRAY_OUI &&
+                        value[3] == LLDP_CRAY_SUBTYPE) {
+                    size_t info_len = length - 4;
+
+                    if (info_len >= org_tlv_len) {
+                        info_len = org_tlv_len - 1;
+                    }
+                    memcpy(org_tlv, value + 4, info_len);
+                    org_tlv[info_len] = '\0';
+                }
+                break;
+            default:
+                break;
+        }
+
+        cp = value + length;
+    }
+
+    /* no End of LLDPDU TLV, take what we found */
+}
+
+bool lldp_decode_frame(const uint8_t *frame, size_t len,
+        fabric_config_t *fc, char *org_tlv, size_t org_tlv_len)
+{
+    const uint8_t *cp = frame + 2 * ETH_ALEN;
+    const uint8_t *end = frame + len;
+    uint16_t ethertype;
+
+    if (len < ETH_HLEN) {
+        return false;
+    }
+
+    ethertype = (cp[0] << 8) | cp[1];
+    cp += 2;
+
+    /* step over a single 802.1Q tag, if present */
+    if (ethertype == ETH_P_8021Q && cp + 4 <= end) {
+        ethertype = (cp[2] << 8) | cp[3];
+        cp += 4;
+    }
+
+    if (ethertype != ETH_P_LLDP) {
+        return false;
+    }
+
+    lldp_decode_tlvs(cp, end - cp, fc, org_tlv, org_tlv_len);
+
+    return true;
+}
+
+static uint32_t pcap_swap32(uint32_t val, bool swapped)
+{
+    return swapped ? __builtin_bswap32(val) : val;
+}
+
+static bool lldp_read_pcap(const char *pcap_file, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_len)
+{
+    struct pcap_file_header hdr;
+    struct pcap_record_header rec;
+    uint8_t frame[LLDP_FRAME_SIZE];
+    bool swapped;
+    bool found = false;
+    FILE *fp;
+
+    fp = fopen(pcap_file, "r");
+    if (!fp) {
+        ERROR("Unable to open capture file %s: %s", pcap_file, strerror(errno));
+        return false;
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1) {
+        ERROR("'%s' is too short to be a capture file", pcap_file);
+        goto close_file;
+    }
+
+    if (hdr.magic == PCAP_MAGIC || hdr.magic == PCAP_MAGIC_NSEC) {
+        swapped = false;
+    } else if (hdr.magic == __builtin_bswap32(PCAP_MAGIC) ||
+            hdr.magic == __builtin_bswap32(PCAP_MAGIC_NSEC)) {
+        swapped = true;
+    } else {
+        ERROR("'%s' is not a pcap capture file", pcap_file);
+        goto close_file;
+    }
+
+    if (pcap_swap32(hdr.linktype, swapped) != PCAP_LINKTYPE_ETHER) {
+        ERROR("'%s' does not contain ethernet frames", pcap_file);
+        goto close_file;
+    }
+
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        uint32_t incl_len = pcap_swap32(rec.incl_len, swapped);
+        size_t frame_len = incl_len;
+
+        if (frame_len > sizeof(frame)) {
+            frame_len = sizeof(frame);
+        }
+
+        if (fread(frame, 1, frame_len, fp) != frame_len ||
+                (incl_len > frame_len &&
+                    fseek(fp, incl_len - frame_len, SEEK_CUR))) {
+            WARN("truncated record in '%s'", pcap_file);
+            break;
+        }
+
+        if (lldp_decode_frame(frame, frame_len, fc, org_tlv, org_tlv_len)) {
+            found = true;
+            break;
+        }
+    }
+
+close_file:
+    fclose(fp);
+
+    return found;
+}
+
+int lldp_open(const char *ifname)
+{
+    struct sockaddr_ll sll = {};
+    struct packet_mreq mreq = {};
+    unsigned int ifindex;
+    int fd;
+
+    ifindex = if_nametoindex(ifname);
+    if (!ifindex) {
+        ERROR("Unable to find interface %s: %s", ifname, strerror(errno));
+        return -1;
+    }
+
+    fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, htons(ETH_P_LLDP));
+    if (fd < 0) {
+        ERROR("Unable to open LLDP socket: %s", strerror(errno));
+        return -1;
+    }
+
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_LLDP);
+    sll.sll_ifindex = ifindex;
+
+    if (bind(fd, (struct sockaddr *) &sll, sizeof(sll))) {
+        ERROR("Unable to bind LLDP socket to %s: %s", ifname, strerror(errno));
+        goto close_socket;
+    }
+
+    mreq.mr_ifindex = ifindex;
+    mreq.mr_type = PACKET_MR_MULTICAST;
+    mreq.mr_alen = ETH_ALEN;
+    memcpy(mreq.mr_address, lldp_mcast_addr, ETH_ALEN);
+
+    if (setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP,
+                &mreq, sizeof(mreq))) {
+        ERROR("Unable to join LLDP multicast group on %s: %s",
+                ifname, strerror(errno));
+        goto close_socket;
+    }
+
+    return fd;
+
+close_socket:
+    close(fd);
+    return -1;
+}
+
+static bool lldp_recv(const char *ifname, int timeout, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_len)
+{
+    uint8_t frame[LLDP_FRAME_SIZE];
+    struct timespec now, deadline;
+    struct pollfd pfd;
+    bool found = false;
+    ssize_t len;
+    int wait_ms;
+
+    pfd.fd = lldp_open(ifname);
+    if (pfd.fd < 0) {
+        return false;
+    }
+    pfd.events = POLLIN;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout;
+
+    VERBOSE("waiting up to %d seconds for an LLDPDU on %s", timeout, ifname);
+
+    while (!found) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        wait_ms = (deadline.tv_sec - now.tv_sec) * 1000 +
+            (deadline.tv_nsec - now.tv_nsec) / 1000000;
+        if (wait_ms <= 0) {
+            break;
+        }
+
+        if (poll(&pfd, 1, wait_ms) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR("poll on LLDP socket failed: %s", strerror(errno));
+            break;
+        }
+
+        if (!(pfd.revents & POLLIN)) {
+            continue;
+        }
+
+        len = recv(pfd.fd, frame, sizeof(frame), 0);
+        if (len < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            ERROR("recv on LLDP socket failed: %s", strerror(errno));
+            break;
+        }
+
+        found = lldp_decode_frame(frame, len, fc, org_tlv, org_tlv_len);
+    }
+
+    close(pfd.fd);
+
+    return found;
+}
+
+bool lldp_get_tlv(fabric_config_t *fc, const char *pcap_file, int timeout,
+        char *org_tlv, size_t org_tlv_len)
+{
+    bool found;
+
+    org_tlv[0] = '\0';
+
+    if (pcap_file) {
+        found = lldp_read_pcap(pcap_file, fc, org_tlv, org_tlv_len);
+    } else {
+        found = lldp_recv(fc->ifname, timeout, fc, org_tlv, org_tlv_len);
+    }
+
+    if (!found) {
+        ERROR("no LLDPDU received from switch");
+        DIAG("check local adapter state. The adapter may be down");
+        DIAG("check Rosetta switch to see if it advertising TLVs on other adapters");
+        return false;
+    }
+
+    return lldp_check_tlv(fc, org_tlv);
+}
+
+/* what has to be in an LLDPDU from the switch, however it was received */
+bool lldp_check_tlv(const fabric_config_t *fc, const char *org_tlv)
+{
+    if (!(fc->have & FC_HAVE_MAC)) {
+        ERROR("LLDPDU from switch did not carry a MAC address");
+        DIAG("check Rosetta switch Chassis ID configuration for LLDP");
+        return false;
+    }
+
+    if (!org_tlv[0]) {
+        ERROR("Missing Org TLV in LLDPDU");
+        DIAG("check Rosetta switch configuration for LLDP. CrayTLV not advertised.");
+        DIAG("Fabric configuration is not active or not advertised");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,580 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+/* local includes */
+#include "debug.h"
+#include "metrics.h"
+#include "tlv.h"
+#include "utils.h"
+
+#define METRICS_PREFIX    "slingshot_lldp_"
+#define METRICS_LINE_SIZE 256
+
+/* histogram bucket bounds in seconds, +Inf is implied */
+static const double metrics_buckets[] = {
+    0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60,
+};
+
+#define METRICS_BUCKETS (sizeof(metrics_buckets) / sizeof(metrics_buckets[0]))
+
+static const char *metrics_failure_names[METRICS_FAILURE_MAX] = {
+    [METRICS_NO_LLDP_DATA] = "no_lldp_data",
+    [METRICS_MISSING_ORG_TLV] = "missing_org_tlv",
+    [METRICS_INVALID_IP] = "invalid_ip",
+    [METRICS_INVALID_MTU] = "invalid_mtu",
+    [METRICS_INVALID_TTL] = "invalid_ttl",
+    [METRICS_COMMAND_FAILED] = "command_failed",
+    [METRICS_OTHER] = "other",
+};
+
+struct metrics_hist {
+    uint64_t buckets[METRICS_BUCKETS];  /* cumulative, as exposed */
+    uint64_t count;
+    double sum;
+};
+
+struct metrics_if {
+    char ifname[IF_NAMESIZE];
+    uint64_t attempts;
+    uint64_t successes;
+    uint64_t failures[METRICS_FAILURE_MAX];
+    struct metrics_hist fetch;
+    struct metrics_hist apply;
+    time_t last_success;
+    time_t last_tlv;
+};
+
+static struct metrics_if *metrics_find(struct metrics_set *set,
+        const char *ifname)
+{
+    struct metrics_if *ifs;
+
+    for (int i = 0; i < set->count; i++) {
+        if (!strcmp(set->ifs[i].ifname, ifname)) {
+            return &set->ifs[i];
+        }
+    }
+
+    ifs = realloc(set->ifs, (set->count + 1) * sizeof(*ifs));
+    if (!ifs) {
+        return NULL;
+    }
+    set->ifs = ifs;
+
+    memset(&ifs[set->count], 0, sizeof(*ifs));
+    strlcpy(ifs[set->count].ifname, ifname, IF_NAMESIZE);
+
+    return &ifs[set->count++];
+}
+
+static void metrics_set_free(struct metrics_set *set)
+{
+    free(set->ifs);
+    set->ifs = NULL;
+    set->count = 0;
+}
+
+static void hist_observe(struct metrics_hist *h, long ms)
+{
+    double secs = ms / 1000.0;
+
+    for (size_t i = 0; i < METRICS_BUCKETS; i++) {
+        if (secs <= metrics_buckets[i]) {
+            h->buckets[i]++;
+        }
+    }
+    h->count++;
+    h->sum += secs;
+}
+
+static void hist_add(struct metrics_hist *to, const struct metrics_hist *from)
+{
+    for (size_t i = 0; i < METRICS_BUCKETS; i++) {
+        to->buckets[i] += from->buckets[i];
+    }
+    to->count += from->count;
+    to->sum += from->sum;
+}
+
+static void metrics_add(struct metrics_if *to, const struct metrics_if *from)
+{
+    to->attempts += from->attempts;
+    to->successes += from->successes;
+    for (int i = 0; i < METRICS_FAILURE_MAX; i++) {
+        to->failures[i] += from->failures[i];
+    }
+    hist_add(&to->fetch, &from->fetch);
+    hist_add(&to->apply, &from->apply);
+    if (from->last_success > to->last_success) {
+        to->last_success = from->last_success;
+    }
+    if (from->last_tlv > to->last_tlv) {
+        to->last_tlv = from->last_tlv;
+    }
+}
+
+/* find label="value" in a label list, value is at most size - 1 long */
+static bool metrics_label(const char *labels, const char *label, char *value,
+        size_t size)
+{
+    char key[32];
+    const char *cp, *end;
+    size_t len;
+
+    len = snprintf(key, sizeof(key), "%s=\"", label);
+    cp = strstr(labels, key);
+    if (!cp) {
+        return false;
+    }
+    cp += len;
+
+    end = strchr(cp, '"');
+    if (!end || (size_t) (end - cp) >= size) {
+        return false;
+    }
+
+    memcpy(value, cp, end - cp);
+    value[end - cp] = '\0';
+
+    return true;
+}
+
+static struct metrics_hist *metrics_hist(struct metrics_if *m,
+        const char *name, const char **suffix)
+{
+    static const char fetch[] = "tlv_fetch_seconds_";
+    static const char apply[] = "apply_seconds_";
+
+    if (!strncmp(name, fetch, sizeof(fetch) - 1)) {
+        *suffix = name + sizeof(fetch) - 1;
+        return &m->fetch;
+    }
+    if (!strncmp(name, apply, sizeof(apply) - 1)) {
+        *suffix = name + sizeof(apply) - 1;
+        return &m->apply;
+    }
+
+    return NULL;
+}
+
+/* one sample line of the file, as written by metrics_write() */
+static void metrics_parse_line(struct metrics_set *set, const char *line)
+{
+    char name[64], labels[128], ifname[IF_NAMESIZE], label[32];
+    struct metrics_hist *h;
+    struct metrics_if *m;
+    const char *suffix;
+    double value;
+
+    if (sscanf(line, METRICS_PREFIX "%63[a-z_]{%127[^}]} %lf", name, labels,
+                &value) != 3 ||
+            !metrics_label(labels, "ifname", ifname, sizeof(ifname))) {
+        return;
+    }
+
+    m = metrics_find(set, ifname);
+    if (!m) {
+        return;
+    }
+
+    if (!strcmp(name, "attempts_total")) {
+        m->attempts = value;
+    } else if (!strcmp(name, "successes_total")) {
+        m->successes = value;
+    } else if (!strcmp(name, "failures_total")) {
+        if (!metrics_label(labels, "reason", label, sizeof(label))) {
+            return;
+        }
+        for (int i = 0; i < METRICS_FAILURE_MAX; i++) {
+            if (!strcmp(label, metrics_failure_names[i])) {
+                m->failures[i] = value;
+            }
+        }
+    } else if (!strcmp(name, "last_success_timestamp_seconds")) {
+        m->last_success = value;
+    } else if (!strcmp(name, "last_tlv_timestamp_seconds")) {
+        m->last_tlv = value;
+    } else if ((h = metrics_hist(m, name, &suffix))) {
+        if (!strcmp(suffix, "count")) {
+            h->count = value;
+        } else if (!strcmp(suffix, "sum")) {
+            h->sum = value;
+        } else if (!strcmp(suffix, "bucket") &&
+                metrics_label(labels, "le", label, sizeof(label))) {
+            for (size_t i = 0; i < METRICS_BUCKETS; i++) {
+                if (strtod(label, NULL) == metrics_buckets[i]) {
+                    h->buckets[i] = value;
+                }
+            }
+        }
+    }
+}
+
+static void metrics_read(struct metrics_set *set, const char *path)
+{
+    char line[METRICS_LINE_SIZE];
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] != '#') {
+            metrics_parse_line(set, line);
+        }
+    }
+
+    fclose(fp);
+}
+
+static void metrics_header(FILE *fp, const char *name, const char *type,
+        const char *help)
+{
+    fprintf(fp, "# HELP " METRICS_PREFIX "%s %s\n", name, help);
+    fprintf(fp, "# TYPE " METRICS_PREFIX "%s %s\n", name, type);
+}
+
+static void metrics_write_hist(FILE *fp, const struct metrics_set *set,
+        const char *name, size_t offset)
+{
+    for (int i = 0; i < set->count; i++) {
+        const struct metrics_hist *h = (const void *) ((const char *)
+                &set->ifs[i] + offset);
+        const char *ifname = set->ifs[i].ifname;
+
+        for (size_t b = 0; b < METRICS_BUCKETS; b++) {
+            fprintf(fp, METRICS_PREFIX "%s_bucket{ifname=\"%s\",le=\"%g\"} "
+                    "%" PRIu64 "\n", name, ifname, metrics_buckets[b],
+                    h->buckets[b]);
+        }
+        fprintf(fp, METRICS_PREFIX "%s_bucket{ifname=\"%s\",le=\"+Inf\"} "
+                "%" PRIu64 "\n", name, ifname, h->count);
+        fprintf(fp, METRICS_PREFIX "%s_sum{ifname=\"%s\"} %.6f\n", name,
+                ifname, h->sum);
+        fprintf(fp, METRICS_PREFIX "%s_count{ifname=\"%s\"} %" PRIu64 "\n",
+                name, ifname, h->count);
+    }
+}
+
+static bool metrics_write(const struct metrics_set *set, FILE *fp)
+{
+    time_t now = time(NULL);
+
+    metrics_header(fp, "attempts_total", "counter",
+            "Attempts to configure the interface from its CrayTLV.");
+    for (int i = 0; i < set->count; i++) {
+        fprintf(fp, METRICS_PREFIX "attempts_total{ifname=\"%s\"} "
+                "%" PRIu64 "\n", set->ifs[i].ifname, set->ifs[i].attempts);
+    }
+
+    metrics_header(fp, "successes_total", "counter",
+            "Attempts that left the interface configured.");
+    for (int i = 0; i < set->count; i++) {
+        fprintf(fp, METRICS_PREFIX "successes_total{ifname=\"%s\"} "
+                "%" PRIu64 "\n", set->ifs[i].ifname, set->ifs[i].successes);
+    }
+
+    metrics_header(fp, "failures_total", "counter",
+            "Failed attempts, by reason.");
+    for (int i = 0; i < set->count; i++) {
+        for (int f = 0; f < METRICS_FAILURE_MAX; f++) {
+            fprintf(fp, METRICS_PREFIX "failures_total{ifname=\"%s\","
+                    "reason=\"%s\"} %" PRIu64 "\n", set->ifs[i].ifname,
+                    metrics_failure_names[f], set->ifs[i].failures[f]);
+        }
+    }
+
+    metrics_header(fp, "tlv_fetch_seconds", "histogram",
+            "Time taken to get the CrayTLV.");
+    metrics_write_hist(fp, set, "tlv_fetch_seconds",
+            offsetof(struct metrics_if, fetch));
+
+    metrics_header(fp, "apply_seconds", "histogram",
+            "Time taken to apply a configuration.");
+    metrics_write_hist(fp, set, "apply_seconds",
+            offsetof(struct metrics_if, apply));
+
+    metrics_header(fp, "last_success_timestamp_seconds", "gauge",
+            "When the interface was last configured successfully.");
+    for (int i = 0; i < set->count; i++) {
+        fprintf(fp, METRICS_PREFIX "last_success_timestamp_seconds"
+                "{ifname=\"%s\"} %ld\n", set->ifs[i].ifname,
+                (long) set->ifs[i].last_success);
+    }
+
+    metrics_header(fp, "last_tlv_timestamp_seconds", "gauge",
+            "When a valid CrayTLV was last received.");
+    for (int i = 0; i < set->count; i++) {
+        fprintf(fp, METRICS_PREFIX "last_tlv_timestamp_seconds"
+                "{ifname=\"%s\"} %ld\n", set->ifs[i].ifname,
+                (long) set->ifs[i].last_tlv);
+    }
+
+    metrics_header(fp, "tlv_age_seconds", "gauge",
+            "Age of the last valid CrayTLV when this file was written.");
+    for (int i = 0; i < set->count; i++) {
+        if (set->ifs[i].last_tlv) {
+            fprintf(fp, METRICS_PREFIX "tlv_age_seconds{ifname=\"%s\"} "
+                    "%ld\n", set->ifs[i].ifname,
+                    (long) (now - set->ifs[i].last_tlv));
+        }
+    }
+
+    return !ferror(fp);
+}
+
+/*
+ * Keep Prometheus textfile metrics in path. Nothing is read or written
+ * until there is something to record.
+ */
+void metrics_init(struct metrics *m)
+{
+    memset(m, 0, sizeof(*m));
+    pthread_mutex_init(&m->lock, NULL);
+    m->lock_fd = -1;
+}
+
+bool metrics_open(struct metrics *m, const char *path)
+{
+    char lock[PATH_MAX];
+
+    if (snprintf(lock, sizeof(lock), "%s.lock", path) >= (int) sizeof(lock)) {
+        ERROR("metrics file name too long: %s", path);
+        return false;
+    }
+
+    /* serializes the read, add and replace with other processes */
+    m->lock_fd = open(lock, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m->lock_fd < 0) {
+        ERROR("Unable to open %s: %s", lock, strerror(errno));
+        return false;
+    }
+
+    m->path = strdup(path);
+    if (!m->path) {
+        ERROR("could not allocate metrics state");
+        close(m->lock_fd);
+        m->lock_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void metrics_close(struct metrics *m)
+{
+    metrics_flush(m);
+
+    free(m->path);
+    m->path = NULL;
+    if (m->lock_fd >= 0) {
+        close(m->lock_fd);
+        m->lock_fd = -1;
+    }
+    metrics_set_free(&m->pending);
+    pthread_mutex_destroy(&m->lock);
+}
+
+/* the first check in check_tlv_data() the config would fail, if any */
+static enum metrics_failure tlv_failure(const fabric_config_t *fc)
+{
+    if (!(fc->have & FC_HAVE_MAC)) {
+        return METRICS_NO_LLDP_DATA;
+    }
+    if (!fc->org_tlv) {
+        return METRICS_MISSING_ORG_TLV;
+    }
+    if (!(fc->have & FC_HAVE_IP)) {
+        return METRICS_INVALID_IP;
+    }
+    if (!(fc->have & FC_HAVE_MTU)) {
+        return METRICS_INVALID_MTU;
+    }
+    if (!(fc->have & FC_HAVE_TTL)) {
+        return METRICS_INVALID_TTL;
+    }
+
+    /* e.g. lldptool exited with an error after printing a whole CrayTLV */
+    return METRICS_OTHER;
+}
+
+/*
+ * A failed fetch ends the attempt, a good one is followed by an apply.
+ * ms < 0 for a CrayTLV that arrived without being asked for.
+ */
+void metrics_tlv_fetched(struct metrics *m, const fabric_config_t *fc,
+        bool ok, long ms)
+{
+    struct metrics_if *mi;
+
+    if (!m->path) {
+        return;
+    }
+
+    pthread_mutex_lock(&m->lock);
+
+    mi = metrics_find(&m->pending, fc->ifname);
+    if (mi) {
+        if (ms >= 0) {
+            hist_observe(&mi->fetch, ms);
+        }
+        if (ok) {
+            mi->last_tlv = time(NULL);
+        } else {
+            mi->attempts++;
+            mi->failures[tlv_failure(fc)]++;
+        }
+        m->dirty = true;
+    }
+
+    pthread_mutex_unlock(&m->lock);
+}
+
+void metrics_applied(struct metrics *m, const char *ifname, bool ok, long ms)
+{
+    struct metrics_if *mi;
+
+    if (!m->path) {
+        return;
+    }
+
+    pthread_mutex_lock(&m->lock);
+
+    mi = metrics_find(&m->pending, ifname);
+    if (mi) {
+        mi->attempts++;
+        hist_observe(&mi->apply, ms);
+        if (ok) {
+            mi->successes++;
+            mi->last_success = time(NULL);
+        } else {
+            mi->failures[METRICS_COMMAND_FAILED]++;
+        }
+        m->dirty = true;
+    }
+
+    pthread_mutex_unlock(&m->lock);
+}
+
+/* the interface already had the configuration, nothing was applied */
+void metrics_confirmed(struct metrics *m, const char *ifname)
+{
+    struct metrics_if *mi;
+
+    if (!m->path) {
+        return;
+    }
+
+    pthread_mutex_lock(&m->lock);
+
+    mi = metrics_find(&m->pending, ifname);
+    if (mi) {
+        mi->attempts++;
+        mi->successes++;
+        mi->last_success = time(NULL);
+        m->dirty = true;
+    }
+
+    pthread_mutex_unlock(&m->lock);
+}
+
+/* add what is pending to the file, replacing it so scrapes see all or none */
+void metrics_flush(struct metrics *m)
+{
+    struct metrics_set set = { NULL, 0 };
+    struct metrics_if *mi;
+    char tmp[PATH_MAX];
+    FILE *fp;
+    bool ok;
+    int fd;
+
+    pthread_mutex_lock(&m->lock);
+
+    if (!m->path || !m->dirty) {
+        pthread_mutex_unlock(&m->lock);
+        return;
+    }
+
+    flock(m->lock_fd, LOCK_EX);
+
+    metrics_read(&set, m->path);
+    for (int i = 0; i < m->pending.count; i++) {
+        mi = metrics_find(&set, m->pending.ifs[i].ifname);
+        if (mi) {
+            metrics_add(mi, &m->pending.ifs[i]);
+        }
+    }
+
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", m->path);
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        WARN("Unable to create %s, metrics not written: %s", tmp,
+                strerror(errno));
+        goto unlock;
+    }
+    fchmod(fd, 0644);
+
+    fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        unlink(tmp);
+        goto unlock;
+    }
+
+    ok = metrics_write(&set, fp);
+    if (fclose(fp) || !ok || rename(tmp, m->path)) {
+        WARN("Unable to write %s: %s", m->path, strerror(errno));
+        unlink(tmp);
+        goto unlock;
+    }
+
+    /* only forget what has made it into the file */
+    metrics_set_free(&m->pending);
+    m->dirty = false;
+
+unlock:
+    flock(m->lock_fd, LOCK_UN);
+    metrics_set_free(&set);
+    pthread_mutex_unlock(&m->lock);
+}
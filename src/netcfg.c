@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* local includes */
+#include "slingshot-netcfg.h"
+#include "cfg_lldp.h"
+#include "clif.h"
+#include "debug.h"
+#include "lldp.h"
+#include "netlink.h"
+#include "tlv.h"
+#include "utils.h"
+
+/* the public values are passed straight through */
+_Static_assert((int) NETCFG_LOG_NONE == (int) DEBUG_LVL_MAX, "log levels differ");
+_Static_assert(NETCFG_HAVE_ALL == FC_HAVE_ALL, "have bits differ");
+_Static_assert(NETCFG_TTL_FOREVER == FC_TTL_FOREVER, "TTL forever differs");
+
+struct netcfg_plan {
+    struct nl_batch batch;
+    char ifname[IF_NAMESIZE];
+};
+
+/* what a call replaces on the calling thread, and puts back */
+struct netcfg_call {
+    struct netcfg *nc;
+    struct debug_sink *sink;
+    struct debug_capture *capture;
+    struct debug_capture captured;
+};
+
+static void netcfg_enter(struct netcfg *nc, struct netcfg_call *call)
+{
+    call->nc = nc;
+    call->sink = debug_sink;
+    call->capture = debug_capture;
+
+    memset(&call->captured, 0, sizeof(call->captured));
+    debug_sink = &nc->log;
+    debug_capture = &call->captured;
+}
+
+/* a failure's error is kept for netcfg_error() until the next failure */
+static bool netcfg_leave(struct netcfg_call *call, bool ret)
+{
+    debug_sink = call->sink;
+    debug_capture = call->capture;
+
+    if (!ret) {
+        call->nc->capture = call->captured;
+    }
+
+    return ret;
+}
+
+static void config_to_fc(const struct netcfg_config *cfg,
+        fabric_config_t *fc, char *ifname)
+{
+    strlcpy(ifname, cfg->ifname, IF_NAMESIZE);
+
+    memset(fc, 0, sizeof(*fc));
+    fc->ifname = ifname;
+    fc->have = cfg->have & FC_HAVE_ALL;
+    memcpy(fc->mac_addr, cfg->mac_addr, sizeof(fc->mac_addr));
+    fc->ip_addr = cfg->ip_addr;
+    fc->prefix = cfg->prefix;
+    fc->mtu = cfg->mtu;
+    fc->ttl = cfg->ttl;
+}
+
+static void fc_to_config(const fabric_config_t *fc,
+        struct netcfg_config *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    strlcpy(cfg->ifname, fc->ifname, sizeof(cfg->ifname));
+    cfg->have = fc->have;
+    memcpy(cfg->mac_addr, fc->mac_addr, sizeof(cfg->mac_addr));
+    cfg->ip_addr = fc->ip_addr;
+    cfg->prefix = fc->prefix;
+    cfg->mtu = fc->mtu;
+    cfg->ttl = fc->ttl;
+}
+
+struct netcfg *netcfg_new(unsigned int flags)
+{
+    struct netcfg *nc;
+
+    nc = calloc(1, sizeof(*nc));
+    if (!nc) {
+        return NULL;
+    }
+
+    nc->options.dry_run = flags & NETCFG_DRY_RUN;
+    nc->options.force = flags & NETCFG_FORCE;
+    nc->options.remove_ip_addrs = flags & NETCFG_REMOVE_IP_ADDRS;
+    nc->options.skip_reload = flags & NETCFG_SKIP_RELOAD;
+
+    nc->log = debug_default_sink;
+    nc->lldpad.fd = -1;
+    config_cache_init(&nc->cache);
+    host_map_init(&nc->host_map);
+    metrics_init(&nc->metrics);
+    pthread_mutex_init(&nc->reload_lock, NULL);
+
+    return nc;
+}
+
+void netcfg_free(struct netcfg *nc)
+{
+    if (!nc) {
+        return;
+    }
+
+    lldpad_close(nc);
+    metrics_close(&nc->metrics);
+    config_cache_free(&nc->cache);
+    host_map_free(&nc->host_map);
+    pthread_mutex_destroy(&nc->reload_lock);
+    free(nc->reload_queue);
+    free(nc->options.config_cache);
+    free(nc->options.host_map);
+    free(nc->options.input_file);
+    free(nc->options.lldpad_socket);
+    free(nc->options.metrics);
+    free(nc);
+}
+
+void netcfg_set_log(struct netcfg *nc, int level, netcfg_log_fn fn,
+        void *arg)
+{
+    nc->log.level = level;
+    nc->log.fn = fn;
+    nc->log.arg = arg;
+}
+
+bool netcfg_set_lldpad_socket(struct netcfg *nc, const char *name)
+{
+    char *copy = strdup(name);
+
+    if (!copy) {
+        return false;
+    }
+
+    /* takes effect on the next session */
+    lldpad_close(nc);
+    free(nc->options.lldpad_socket);
+    nc->options.lldpad_socket = copy;
+
+    return true;
+}
+
+const char *netcfg_error(const struct netcfg *nc)
+{
+    return nc->capture.error;
+}
+
+bool netcfg_fetch_tlv(struct netcfg *nc, const char *ifname, uint8_t *buf,
+        size_t size, size_t *len)
+{
+    const char *sock_name = nc->options.lldpad_socket ?
+            nc->options.lldpad_socket : CLIF_SOCK_NAME;
+    struct netcfg_call call;
+
+    netcfg_enter(nc, &call);
+
+    *len = 0;
+
+    if (nc->lldpad.fd < 0 &&
+            !clif_open(&nc->lldpad, sock_name, CLIF_TIMEOUT_MS)) {
+        return netcfg_leave(&call, false);
+    }
+
+    return netcfg_leave(&call,
+            clif_get_tlvs(&nc->lldpad, ifname, buf, size, len));
+}
+
+bool netcfg_parse(struct netcfg *nc, const char *ifname, const uint8_t *buf,
+        size_t len, struct netcfg_config *cfg)
+{
+    char org_tlv[LLDP_ORG_TLV_SIZE] = "";
+    char name[IF_NAMESIZE];
+    fabric_config_t fc = { .ifname = name };
+    struct netcfg_call call;
+    bool ret;
+
+    netcfg_enter(nc, &call);
+
+    strlcpy(name, ifname, sizeof(name));
+
+    lldp_decode_tlvs(buf, len, &fc, org_tlv, sizeof(org_tlv));
+    ret = lldp_check_tlv(&fc, org_tlv) && decode_tlv(&fc, org_tlv);
+
+    fc_to_config(&fc, cfg);
+
+    return netcfg_leave(&call, ret);
+}
+
+bool netcfg_validate(struct netcfg *nc, const struct netcfg_config *cfg)
+{
+    char ifname[IF_NAMESIZE];
+    struct netcfg_call call;
+    fabric_config_t fc;
+
+    netcfg_enter(nc, &call);
+
+    config_to_fc(cfg, &fc, ifname);
+
+    return netcfg_leave(&call, is_valid_tlv_data(&fc));
+}
+
+bool netcfg_plan(struct netcfg *nc, const struct netcfg_config *cfg,
+        struct netcfg_plan **plan)
+{
+    struct netcfg_plan *p;
+    struct netcfg_call call;
+    fabric_config_t fc;
+
+    netcfg_enter(nc, &call);
+
+    *plan = NULL;
+
+    p = calloc(1, sizeof(*p));
+    if (!p) {
+        ERROR("could not allocate a plan for %s", cfg->ifname);
+        return netcfg_leave(&call, false);
+    }
+
+    config_to_fc(cfg, &fc, p->ifname);
+
+    if (!is_valid_tlv_data(&fc)) {
+        free(p);
+        return netcfg_leave(&call, false);
+    }
+
+    if (!nl_batch_init(&p->batch, nc->options.dry_run)) {
+        free(p);
+        return netcfg_leave(&call, false);
+    }
+
+    if (!plan_netlink_cmds(nc, &fc, &p->batch)) {
+        netcfg_plan_free(p);
+        return netcfg_leave(&call, false);
+    }
+
+    *plan = p;
+
+    return netcfg_leave(&call, true);
+}
+
+int netcfg_plan_steps(const struct netcfg_plan *plan)
+{
+    return plan->batch.count;
+}
+
+const char *netcfg_plan_step(const struct netcfg_plan *plan, int idx)
+{
+    if (idx < 0 || idx >= plan->batch.count) {
+        return NULL;
+    }
+
+    return plan->batch.desc[idx];
+}
+
+/* every step is sent, and the plan is empty afterwards */
+bool netcfg_apply(struct netcfg *nc, struct netcfg_plan *plan)
+{
+    struct netcfg_call call;
+    int failed;
+
+    netcfg_enter(nc, &call);
+
+    if (!plan->batch.count) {
+        VERBOSE("%s: already converged, nothing to do", plan->ifname);
+        return netcfg_leave(&call, true);
+    }
+
+    failed = nl_batch_commit(&plan->batch);
+    if (failed) {
+        ERROR("%s: netlink configuration failed", plan->ifname);
+    }
+
+    return netcfg_leave(&call, !failed);
+}
+
+void netcfg_plan_free(struct netcfg_plan *plan)
+{
+    if (!plan) {
+        return;
+    }
+
+    nl_batch_free(&plan->batch);
+    free(plan);
+}
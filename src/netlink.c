@@ -0,0 +1,1066 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/rtnetlink.h>
+#include <linux/fib_rules.h>
+#include <linux/neighbour.h>
+
+/* local includes */
+#include "debug.h"
+#include "netlink.h"
+
+#define NL_RECV_SIZE  32768
+#define NL_SEND_CHUNK 32768
+#define NL_DESC_SIZE  256
+
+#ifndef SOL_NETLINK
+#define SOL_NETLINK 270
+#endif
+
+union nl_req {
+    struct nlmsghdr n;
+    char buf[NL_MSG_SIZE];
+};
+
+void nl_msg_init(struct nlmsghdr *n, uint16_t type, uint16_t flags,
+        const void *hdr, size_t hdr_len)
+{
+    memset(n, 0, NLMSG_SPACE(hdr_len));
+    n->nlmsg_len = NLMSG_LENGTH(hdr_len);
+    n->nlmsg_type = type;
+    n->nlmsg_flags = NLM_F_REQUEST | flags;
+    memcpy(NLMSG_DATA(n), hdr, hdr_len);
+}
+
+bool nl_attr_put(struct nlmsghdr *n, uint16_t type,
+        const void *data, size_t len)
+{
+    struct rtattr *rta;
+    size_t rta_len = RTA_LENGTH(len);
+
+    if (NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(rta_len) > NL_MSG_SIZE) {
+        ERROR("netlink attribute %u does not fit in request", type);
+        return false;
+    }
+
+    rta = (struct rtattr *) ((char *) n + NLMSG_ALIGN(n->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = rta_len;
+    memcpy(RTA_DATA(rta), data, len);
+    n->nlmsg_len = NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(rta_len);
+
+    return true;
+}
+
+/* open a socket subscribed to the given RTMGRP_* multicast groups */
+int nl_monitor_open(uint32_t groups)
+{
+    struct sockaddr_nl snl = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = groups,
+    };
+    int fd;
+
+    fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        ERROR("Unable to open rtnetlink socket: %s", strerror(errno));
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr *) &snl, sizeof(snl))) {
+        ERROR("Unable to bind rtnetlink socket: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool nl_batch_init(struct nl_batch *b, bool dry_run)
+{
+    struct sockaddr_nl snl = { .nl_family = AF_NETLINK };
+    int one = 1;
+
+    memset(b, 0, sizeof(*b));
+    b->fd = -1;
+    b->dry_run = dry_run;
+    b->seq = time(NULL);
+
+    /* a dry run may still read kernel state, but can do without it */
+    b->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (b->fd < 0) {
+        if (dry_run) {
+            return true;
+        }
+        ERROR("Unable to open rtnetlink socket: %s", strerror(errno));
+        return false;
+    }
+
+    if (bind(b->fd, (struct sockaddr *) &snl, sizeof(snl))) {
+        close(b->fd);
+        b->fd = -1;
+        if (dry_run) {
+            return true;
+        }
+        ERROR("Unable to bind rtnetlink socket: %s", strerror(errno));
+        return false;
+    }
+
+    /* ask for error strings, and do not echo our requests back */
+    setsockopt(b->fd, SOL_NETLINK, NETLINK_EXT_ACK, &one, sizeof(one));
+    setsockopt(b->fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+
+    return true;
+}
+
+/* drop everything queued and not yet committed */
+void nl_batch_reset(struct nl_batch *b)
+{
+    for (int i = 0; i < b->count; i++) {
+        free(b->desc[i]);
+    }
+
+    b->seq += b->count;
+    b->count = 0;
+    b->len = 0;
+}
+
+void nl_batch_free(struct nl_batch *b)
+{
+    nl_batch_reset(b);
+
+    free(b->buf);
+    free(b->desc);
+
+    if (b->fd >= 0) {
+        close(b->fd);
+    }
+
+    memset(b, 0, sizeof(*b));
+    b->fd = -1;
+}
+
+bool nl_batch_add(struct nl_batch *b, const struct nlmsghdr *n,
+        const char *fmt, ...)
+{
+    size_t msg_len = NLMSG_ALIGN(n->nlmsg_len);
+    struct nlmsghdr *dst;
+    va_list ap;
+
+    if (b->len + msg_len > b->size) {
+        size_t size = b->size ? b->size * 2 : NL_SEND_CHUNK;
+        char *buf;
+
+        while (size < b->len + msg_len) {
+            size *= 2;
+        }
+
+        buf = realloc(b->buf, size);
+        if (!buf) {
+            ERROR("failed to allocate memory for netlink batch");
+            return false;
+        }
+        b->buf = buf;
+        b->size = size;
+    }
+
+    if (b->count == b->max) {
+        int max = b->max ? b->max * 2 : 16;
+        char **desc = realloc(b->desc, max * sizeof(*desc));
+
+        if (!desc) {
+            ERROR("failed to allocate memory for netlink batch");
+            return false;
+        }
+        b->desc = desc;
+        b->max = max;
+    }
+
+    b->desc[b->count] = malloc(NL_DESC_SIZE);
+    if (!b->desc[b->count]) {
+        ERROR("failed to allocate memory for netlink batch");
+        return false;
+    }
+
+    va_start(ap, fmt);
+    vsnprintf(b->desc[b->count], NL_DESC_SIZE, fmt, ap);
+    va_end(ap);
+
+    dst = (struct nlmsghdr *) (b->buf + b->len);
+    memcpy(dst, n, n->nlmsg_len);
+    dst->nlmsg_flags |= NLM_F_ACK;
+    dst->nlmsg_seq = b->seq + b->count;
+
+    b->len += msg_len;
+    b->count++;
+
+    return true;
+}
+
+static const char *nl_ext_ack_msg(const struct nlmsghdr *n)
+{
+    const struct nlmsgerr *err = NLMSG_DATA(n);
+    const struct rtattr *rta;
+    int len;
+
+    if (!(n->nlmsg_flags & NLM_F_ACK_TLVS)) {
+        return NULL;
+    }
+
+    /* NETLINK_CAP_ACK is set, so only the header of our request follows */
+    rta = (const struct rtattr *) ((const char *) err + sizeof(*err));
+    len = n->nlmsg_len - NLMSG_LENGTH(sizeof(*err));
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == NLMSGERR_ATTR_MSG) {
+            return RTA_DATA(rta);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Read acks until every request in [first, last) has been answered.
+ * Returns the number of requests the kernel rejected, or -1 if the
+ * socket itself failed.
+ */
+static int nl_batch_wait(struct nl_batch *b, int first, int last)
+{
+    char buf[NL_RECV_SIZE];
+    int pending = last - first;
+    int failed = 0;
+
+    while (pending > 0) {
+        struct nlmsghdr *n;
+        ssize_t len;
+
+        len = recv(b->fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR("rtnetlink receive failed: %s", strerror(errno));
+            return -1;
+        }
+
+        for (n = (struct nlmsghdr *) buf; NLMSG_OK(n, len);
+                n = NLMSG_NEXT(n, len)) {
+            const struct nlmsgerr *err = NLMSG_DATA(n);
+            int idx = n->nlmsg_seq - b->seq;
+            const char *msg;
+
+            if (n->nlmsg_type != NLMSG_ERROR ||
+                    idx < first || idx >= last) {
+                continue;
+            }
+
+            pending--;
+
+            if (!err->error) {
+                DEBUG("netlink: '%s' succeeded", b->desc[idx]);
+                continue;
+            }
+
+            failed++;
+            msg = nl_ext_ack_msg(n);
+            if (msg) {
+                ERROR("netlink: '%s' failed: %s (%s)", b->desc[idx],
+                        strerror(-err->error), msg);
+            } else {
+                ERROR("netlink: '%s' failed: %s", b->desc[idx],
+                        strerror(-err->error));
+            }
+        }
+    }
+
+    return failed;
+}
+
+int nl_batch_commit(struct nl_batch *b)
+{
+    size_t off = 0;
+    int failed = 0;
+    int idx = 0;
+
+    for (int i = 0; i < b->count; i++) {
+        VERBOSE("netlink request: %s", b->desc[i]);
+    }
+
+    if (b->dry_run || !b->count) {
+        nl_batch_reset(b);
+        return 0;
+    }
+
+    /*
+     * Send in chunks of whole messages so the acks for one chunk always
+     * fit in the socket receive buffer before the next is sent.
+     */
+    while (off < b->len) {
+        size_t chunk = 0;
+        int first = idx;
+        ssize_t sent;
+        int ret;
+
+        while (off + chunk < b->len) {
+            struct nlmsghdr *n = (struct nlmsghdr *) (b->buf + off + chunk);
+            size_t msg_len = NLMSG_ALIGN(n->nlmsg_len);
+
+            if (chunk && chunk + msg_len > NL_SEND_CHUNK) {
+                break;
+            }
+            chunk += msg_len;
+            idx++;
+        }
+
+        sent = send(b->fd, b->buf + off, chunk, 0);
+        if (sent < 0 || (size_t) sent != chunk) {
+            ERROR("rtnetlink send failed: %s",
+                    sent < 0 ? strerror(errno) : "short write");
+            failed = -1;
+            break;
+        }
+
+        ret = nl_batch_wait(b, first, idx);
+        if (ret < 0) {
+            failed = -1;
+            break;
+        }
+        failed += ret;
+        off += chunk;
+    }
+
+    nl_batch_reset(b);
+
+    return failed;
+}
+
+bool nl_dump(struct nl_batch *b, uint16_t type, const void *hdr,
+        size_t hdr_len, nl_dump_cb cb, void *arg)
+{
+    union nl_req req;
+    char buf[NL_RECV_SIZE];
+    uint32_t seq = b->seq + b->count + 1000000;
+
+    if (b->fd < 0) {
+        return true;
+    }
+
+    nl_msg_init(&req.n, type, NLM_F_DUMP, hdr, hdr_len);
+    req.n.nlmsg_seq = seq;
+
+    if (send(b->fd, &req, req.n.nlmsg_len, 0) < 0) {
+        ERROR("rtnetlink dump request failed: %s", strerror(errno));
+        return false;
+    }
+
+    while (1) {
+        struct nlmsghdr *n;
+        ssize_t len;
+
+        len = recv(b->fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERROR("rtnetlink receive failed: %s", strerror(errno));
+            return false;
+        }
+
+        for (n = (struct nlmsghdr *) buf; NLMSG_OK(n, len);
+                n = NLMSG_NEXT(n, len)) {
+            if (n->nlmsg_seq != seq) {
+                continue;
+            }
+            if (n->nlmsg_type == NLMSG_DONE) {
+                return true;
+            }
+            if (n->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *err = NLMSG_DATA(n);
+
+                ERROR("rtnetlink dump failed: %s", strerror(-err->error));
+                return false;
+            }
+            cb(n, arg);
+        }
+    }
+}
+
+bool nl_link_set_up(struct nl_batch *b, int ifindex, const char *ifname,
+        bool up)
+{
+    struct ifinfomsg ifi = {
+        .ifi_family = AF_UNSPEC,
+        .ifi_index = ifindex,
+        .ifi_flags = up ? IFF_UP : 0,
+        .ifi_change = IFF_UP,
+    };
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+
+    return nl_batch_add(b, &req.n, "link set dev %s %s",
+            ifname, up ? "up" : "down");
+}
+
+bool nl_link_set_addr(struct nl_batch *b, int ifindex, const char *ifname,
+        const uint8_t *mac_addr)
+{
+    struct ifinfomsg ifi = {
+        .ifi_family = AF_UNSPEC,
+        .ifi_index = ifindex,
+    };
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+    if (!nl_attr_put(&req.n, IFLA_ADDRESS, mac_addr, ETH_ALEN)) {
+        return false;
+    }
+
+    return nl_batch_add(b, &req.n,
+            "link set dev %s addr %02x:%02x:%02x:%02x:%02x:%02x", ifname,
+            mac_addr[0], mac_addr[1], mac_addr[2],
+            mac_addr[3], mac_addr[4], mac_addr[5]);
+}
+
+bool nl_link_set_mtu(struct nl_batch *b, int ifindex, const char *ifname,
+        uint32_t mtu)
+{
+    struct ifinfomsg ifi = {
+        .ifi_family = AF_UNSPEC,
+        .ifi_index = ifindex,
+    };
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+    if (!nl_attr_put(&req.n, IFLA_MTU, &mtu, sizeof(mtu))) {
+        return false;
+    }
+
+    return nl_batch_add(b, &req.n, "link set dev %s mtu %u", ifname, mtu);
+}
+
+bool nl_addr_add(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, int prefix, uint32_t valid_lft,
+        uint32_t preferred_lft, bool replace)
+{
+    struct ifaddrmsg ifa = {
+        .ifa_family = AF_INET,
+        .ifa_prefixlen = prefix,
+        .ifa_index = ifindex,
+    };
+    struct ifa_cacheinfo ci = {
+        .ifa_valid = valid_lft,
+        .ifa_prefered = preferred_lft,
+    };
+    char addr_str[INET_ADDRSTRLEN];
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_NEWADDR,
+            NLM_F_CREATE | (replace ? NLM_F_REPLACE : NLM_F_EXCL),
+            &ifa, sizeof(ifa));
+    if (!nl_attr_put(&req.n, IFA_LOCAL, &addr, sizeof(addr)) ||
+            !nl_attr_put(&req.n, IFA_ADDRESS, &addr, sizeof(addr)) ||
+            !nl_attr_put(&req.n, IFA_CACHEINFO, &ci, sizeof(ci))) {
+        return false;
+    }
+
+    inet_ntop(AF_INET, &addr, addr_str, sizeof(addr_str));
+
+    return nl_batch_add(b, &req.n, "addr %s %s/%d dev %s",
+            replace ? "replace" : "add", addr_str, prefix, ifname);
+}
+
+bool nl_addr_del(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, int prefix)
+{
+    struct ifaddrmsg ifa = {
+        .ifa_family = AF_INET,
+        .ifa_prefixlen = prefix,
+        .ifa_index = ifindex,
+    };
+    char addr_str[INET_ADDRSTRLEN];
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_DELADDR, 0, &ifa, sizeof(ifa));
+    if (!nl_attr_put(&req.n, IFA_LOCAL, &addr, sizeof(addr))) {
+        return false;
+    }
+
+    inet_ntop(AF_INET, &addr, addr_str, sizeof(addr_str));
+
+    return nl_batch_add(b, &req.n, "addr del %s/%d dev %s",
+            addr_str, prefix, ifname);
+}
+
+struct addr_flush_ctx {
+    struct nl_batch *b;
+    int ifindex;
+    const char *ifname;
+    bool ok;
+};
+
+static void addr_flush_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct addr_flush_ctx *ctx = arg;
+    const struct ifaddrmsg *ifa = NLMSG_DATA(n);
+    const struct rtattr *rta = IFA_RTA(ifa);
+    int len = IFA_PAYLOAD(n);
+    char addr_str[INET6_ADDRSTRLEN] = "?";
+    union nl_req req;
+
+    if (n->nlmsg_type != RTM_NEWADDR || (int) ifa->ifa_index != ctx->ifindex) {
+        return;
+    }
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFA_ADDRESS) {
+            inet_ntop(ifa->ifa_family, RTA_DATA(rta),
+                    addr_str, sizeof(addr_str));
+        }
+    }
+
+    /* replay the address back as a delete, attributes and all */
+    if (n->nlmsg_len > NL_MSG_SIZE) {
+        WARN("not removing %s/%d from %s, its dump entry is %u bytes",
+                addr_str, ifa->ifa_prefixlen, ctx->ifname, n->nlmsg_len);
+        return;
+    }
+    memcpy(&req, n, n->nlmsg_len);
+    req.n.nlmsg_type = RTM_DELADDR;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+
+    if (!nl_batch_add(ctx->b, &req.n, "addr del %s/%d dev %s",
+                addr_str, ifa->ifa_prefixlen, ctx->ifname)) {
+        ctx->ok = false;
+    }
+}
+
+bool nl_addr_flush(struct nl_batch *b, int ifindex, const char *ifname)
+{
+    struct ifaddrmsg ifa = { .ifa_family = AF_UNSPEC };
+    struct addr_flush_ctx ctx = {
+        .b = b,
+        .ifindex = ifindex,
+        .ifname = ifname,
+        .ok = true,
+    };
+
+    if (b->dry_run) {
+        union nl_req req;
+
+        nl_msg_init(&req.n, RTM_DELADDR, 0, &ifa, sizeof(ifa));
+        return nl_batch_add(b, &req.n, "addr flush dev %s", ifname);
+    }
+
+    if (!nl_dump(b, RTM_GETADDR, &ifa, sizeof(ifa), addr_flush_cb, &ctx)) {
+        return false;
+    }
+
+    return ctx.ok;
+}
+
+struct link_state_ctx {
+    int ifindex;
+    struct nl_link_state *st;
+    bool found;
+};
+
+static void link_state_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct link_state_ctx *ctx = arg;
+    const struct ifinfomsg *ifi = NLMSG_DATA(n);
+    const struct rtattr *rta = IFLA_RTA(ifi);
+    int len = IFLA_PAYLOAD(n);
+
+    if (n->nlmsg_type != RTM_NEWLINK || ifi->ifi_index != ctx->ifindex) {
+        return;
+    }
+
+    ctx->found = true;
+    ctx->st->up = ifi->ifi_flags & IFF_UP;
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_ADDRESS && RTA_PAYLOAD(rta) == ETH_ALEN) {
+            memcpy(ctx->st->mac_addr, RTA_DATA(rta), ETH_ALEN);
+        } else if (rta->rta_type == IFLA_MTU) {
+            ctx->st->mtu = *(uint32_t *) RTA_DATA(rta);
+        }
+    }
+}
+
+static void addr_state_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct link_state_ctx *ctx = arg;
+    const struct ifaddrmsg *ifa = NLMSG_DATA(n);
+    const struct rtattr *rta = IFA_RTA(ifa);
+    int len = IFA_PAYLOAD(n);
+    struct nl_link_state *st = ctx->st;
+
+    if (n->nlmsg_type != RTM_NEWADDR || ifa->ifa_family != AF_INET ||
+            (int) ifa->ifa_index != ctx->ifindex ||
+            st->naddrs == NL_MAX_ADDRS) {
+        return;
+    }
+
+    st->addrs[st->naddrs].prefix = ifa->ifa_prefixlen;
+    st->addrs[st->naddrs].valid_lft = NL_LIFETIME_FOREVER;
+    st->addrs[st->naddrs].preferred_lft = NL_LIFETIME_FOREVER;
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFA_LOCAL) {
+            memcpy(&st->addrs[st->naddrs].addr, RTA_DATA(rta),
+                    sizeof(struct in_addr));
+        } else if (rta->rta_type == IFA_CACHEINFO) {
+            const struct ifa_cacheinfo *ci = RTA_DATA(rta);
+
+            st->addrs[st->naddrs].valid_lft = ci->ifa_valid;
+            st->addrs[st->naddrs].preferred_lft = ci->ifa_prefered;
+        }
+    }
+
+    st->naddrs++;
+}
+
+/*
+ * Read the link-layer address, MTU, admin state and IPv4 addresses the
+ * kernel currently has for an interface. Returns false if they could
+ * not be read, including in a dry run without an rtnetlink socket.
+ */
+bool nl_link_state_get(struct nl_batch *b, int ifindex,
+        struct nl_link_state *st)
+{
+    struct ifinfomsg ifi = { .ifi_family = AF_UNSPEC };
+    struct ifaddrmsg ifa = { .ifa_family = AF_INET };
+    struct link_state_ctx ctx = {
+        .ifindex = ifindex,
+        .st = st,
+        .found = false,
+    };
+
+    memset(st, 0, sizeof(*st));
+
+    if (b->fd < 0 || !ifindex) {
+        return false;
+    }
+
+    if (!nl_dump(b, RTM_GETLINK, &ifi, sizeof(ifi), link_state_cb, &ctx) ||
+            !ctx.found) {
+        return false;
+    }
+
+    return nl_dump(b, RTM_GETADDR, &ifa, sizeof(ifa), addr_state_cb, &ctx);
+}
+
+/* grow a dump result array by one element, returning the new slot */
+static void *nl_list_grow(void **list, int *count, size_t size)
+{
+    char *items = realloc(*list, (*count + 1) * size);
+
+    if (!items) {
+        return NULL;
+    }
+    *list = items;
+
+    memset(items + *count * size, 0, size);
+
+    return items + (*count)++ * size;
+}
+
+struct rule_list_ctx {
+    struct nl_rule *rules;
+    int count;
+    bool ok;
+};
+
+static void rule_list_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct rule_list_ctx *ctx = arg;
+    const struct fib_rule_hdr *frh = NLMSG_DATA(n);
+    const struct rtattr *rta = (const struct rtattr *) ((const char *) frh +
+            NLMSG_ALIGN(sizeof(*frh)));
+    int len = n->nlmsg_len - NLMSG_LENGTH(sizeof(*frh));
+    struct nl_rule *r;
+
+    if (n->nlmsg_type != RTM_NEWRULE || frh->family != AF_INET) {
+        return;
+    }
+
+    r = nl_list_grow((void **) &ctx->rules, &ctx->count, sizeof(*r));
+    if (!r) {
+        ctx->ok = false;
+        return;
+    }
+
+    r->table = frh->table;
+    r->src_len = frh->src_len;
+    r->dst_len = frh->dst_len;
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        switch (rta->rta_type) {
+        case FRA_PRIORITY:
+            r->pref = *(uint32_t *) RTA_DATA(rta);
+            break;
+        case FRA_TABLE:
+            r->table = *(uint32_t *) RTA_DATA(rta);
+            break;
+        case FRA_SRC:
+            memcpy(&r->src, RTA_DATA(rta), sizeof(r->src));
+            break;
+        case FRA_DST:
+            memcpy(&r->dst, RTA_DATA(rta), sizeof(r->dst));
+            break;
+        case FRA_IIFNAME:
+            snprintf(r->iifname, sizeof(r->iifname), "%s",
+                    (const char *) RTA_DATA(rta));
+            break;
+        }
+    }
+}
+
+/* every IPv4 policy routing rule, in a malloc'd array */
+bool nl_rule_list(struct nl_batch *b, struct nl_rule **rules, int *count)
+{
+    struct fib_rule_hdr frh = { .family = AF_INET };
+    struct rule_list_ctx ctx = { NULL, 0, true };
+
+    if (!nl_dump(b, RTM_GETRULE, &frh, sizeof(frh), rule_list_cb, &ctx) ||
+            !ctx.ok) {
+        free(ctx.rules);
+        return false;
+    }
+
+    *rules = ctx.rules;
+    *count = ctx.count;
+
+    return true;
+}
+
+static int nl_rule_desc(const struct nl_rule *r, char *buf, size_t size)
+{
+    char src[INET_ADDRSTRLEN], dst[INET_ADDRSTRLEN];
+    int len = 0;
+
+    inet_ntop(AF_INET, &r->src, src, sizeof(src));
+    inet_ntop(AF_INET, &r->dst, dst, sizeof(dst));
+
+    len += snprintf(buf + len, size - len, "rule from ");
+    if (r->src_len) {
+        len += snprintf(buf + len, size - len, "%s/%u", src, r->src_len);
+    } else {
+        len += snprintf(buf + len, size - len, "all");
+    }
+    if (r->dst_len) {
+        len += snprintf(buf + len, size - len, " to %s/%u", dst, r->dst_len);
+    }
+    if (r->iifname[0]) {
+        len += snprintf(buf + len, size - len, " iif %s", r->iifname);
+    }
+
+    return len + snprintf(buf + len, size - len, " lookup %u pref %u",
+            r->table, r->pref);
+}
+
+static bool nl_rule_msg(struct nl_batch *b, uint16_t type, uint16_t flags,
+        const struct nl_rule *r, const char *verb)
+{
+    struct fib_rule_hdr frh = {
+        .family = AF_INET,
+        .src_len = r->src_len,
+        .dst_len = r->dst_len,
+        .table = r->table < 256 ? r->table : RT_TABLE_UNSPEC,
+        .action = FR_ACT_TO_TBL,
+    };
+    char desc[NL_DESC_SIZE];
+    union nl_req req;
+
+    nl_msg_init(&req.n, type, flags, &frh, sizeof(frh));
+    if (!nl_attr_put(&req.n, FRA_PRIORITY, &r->pref, sizeof(r->pref)) ||
+            !nl_attr_put(&req.n, FRA_TABLE, &r->table, sizeof(r->table)) ||
+            (r->src_len &&
+                !nl_attr_put(&req.n, FRA_SRC, &r->src, sizeof(r->src))) ||
+            (r->dst_len &&
+                !nl_attr_put(&req.n, FRA_DST, &r->dst, sizeof(r->dst))) ||
+            (r->iifname[0] && !nl_attr_put(&req.n, FRA_IIFNAME,
+                r->iifname, strlen(r->iifname) + 1))) {
+        return false;
+    }
+
+    nl_rule_desc(r, desc, sizeof(desc));
+
+    return nl_batch_add(b, &req.n, "%s %s", verb, desc);
+}
+
+bool nl_rule_add(struct nl_batch *b, const struct nl_rule *r)
+{
+    return nl_rule_msg(b, RTM_NEWRULE, NLM_F_CREATE | NLM_F_EXCL, r, "add");
+}
+
+bool nl_rule_del(struct nl_batch *b, const struct nl_rule *r)
+{
+    return nl_rule_msg(b, RTM_DELRULE, 0, r, "del");
+}
+
+struct route_list_ctx {
+    struct nl_route *routes;
+    int count;
+    bool ok;
+};
+
+static void route_list_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct route_list_ctx *ctx = arg;
+    const struct rtmsg *rtm = NLMSG_DATA(n);
+    const struct rtattr *rta = RTM_RTA(rtm);
+    int len = RTM_PAYLOAD(n);
+    struct nl_route *r;
+
+    if (n->nlmsg_type != RTM_NEWROUTE || rtm->rtm_family != AF_INET) {
+        return;
+    }
+
+    r = nl_list_grow((void **) &ctx->routes, &ctx->count, sizeof(*r));
+    if (!r) {
+        ctx->ok = false;
+        return;
+    }
+
+    r->table = rtm->rtm_table;
+    r->dst_len = rtm->rtm_dst_len;
+    r->protocol = rtm->rtm_protocol;
+    r->scope = rtm->rtm_scope;
+    r->flags = rtm->rtm_flags;
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        switch (rta->rta_type) {
+        case RTA_TABLE:
+            r->table = *(uint32_t *) RTA_DATA(rta);
+            break;
+        case RTA_DST:
+            memcpy(&r->dst, RTA_DATA(rta), sizeof(r->dst));
+            break;
+        case RTA_OIF:
+            r->oif = *(int *) RTA_DATA(rta);
+            break;
+        case RTA_GATEWAY:
+            memcpy(&r->gateway, RTA_DATA(rta), sizeof(r->gateway));
+            break;
+        case RTA_PRIORITY:
+            r->priority = *(uint32_t *) RTA_DATA(rta);
+            break;
+        case RTA_PREFSRC:
+            memcpy(&r->prefsrc, RTA_DATA(rta), sizeof(r->prefsrc));
+            break;
+        }
+    }
+}
+
+/* every IPv4 route in every table, in a malloc'd array */
+bool nl_route_list(struct nl_batch *b, struct nl_route **routes, int *count)
+{
+    struct rtmsg rtm = { .rtm_family = AF_INET };
+    struct route_list_ctx ctx = { NULL, 0, true };
+
+    if (!nl_dump(b, RTM_GETROUTE, &rtm, sizeof(rtm), route_list_cb, &ctx) ||
+            !ctx.ok) {
+        free(ctx.routes);
+        return false;
+    }
+
+    *routes = ctx.routes;
+    *count = ctx.count;
+
+    return true;
+}
+
+bool nl_route_replace(struct nl_batch *b, const struct nl_route *r,
+        const char *ifname)
+{
+    struct rtmsg rtm = {
+        .rtm_family = AF_INET,
+        .rtm_dst_len = r->dst_len,
+        .rtm_table = r->table < 256 ? r->table : RT_TABLE_UNSPEC,
+        .rtm_protocol = r->protocol,
+        .rtm_scope = r->scope,
+        .rtm_type = RTN_UNICAST,
+        .rtm_flags = r->flags,
+    };
+    char addr[INET_ADDRSTRLEN];
+    char desc[NL_DESC_SIZE];
+    union nl_req req;
+    int len;
+
+    nl_msg_init(&req.n, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_REPLACE,
+            &rtm, sizeof(rtm));
+    if (!nl_attr_put(&req.n, RTA_TABLE, &r->table, sizeof(r->table)) ||
+            !nl_attr_put(&req.n, RTA_DST, &r->dst, sizeof(r->dst)) ||
+            (r->oif &&
+                !nl_attr_put(&req.n, RTA_OIF, &r->oif, sizeof(r->oif))) ||
+            (r->gateway.s_addr && !nl_attr_put(&req.n, RTA_GATEWAY,
+                &r->gateway, sizeof(r->gateway))) ||
+            (r->priority && !nl_attr_put(&req.n, RTA_PRIORITY,
+                &r->priority, sizeof(r->priority))) ||
+            (r->prefsrc.s_addr && !nl_attr_put(&req.n, RTA_PREFSRC,
+                &r->prefsrc, sizeof(r->prefsrc)))) {
+        return false;
+    }
+
+    inet_ntop(AF_INET, &r->dst, addr, sizeof(addr));
+    len = snprintf(desc, sizeof(desc), "route replace table %u %s/%u",
+            r->table, addr, r->dst_len);
+    if (r->gateway.s_addr) {
+        inet_ntop(AF_INET, &r->gateway, addr, sizeof(addr));
+        len += snprintf(desc + len, sizeof(desc) - len, " via %s", addr);
+    }
+    if (ifname) {
+        len += snprintf(desc + len, sizeof(desc) - len, " dev %s", ifname);
+    }
+    len += snprintf(desc + len, sizeof(desc) - len, " proto %u scope %u",
+            r->protocol, r->scope);
+    if (r->priority) {
+        len += snprintf(desc + len, sizeof(desc) - len, " metric %u",
+                r->priority);
+    }
+    if (r->prefsrc.s_addr) {
+        inet_ntop(AF_INET, &r->prefsrc, addr, sizeof(addr));
+        snprintf(desc + len, sizeof(desc) - len, " src %s", addr);
+    }
+
+    return nl_batch_add(b, &req.n, "%s", desc);
+}
+
+bool nl_neigh_replace(struct nl_batch *b, int ifindex, const char *ifname,
+        struct in_addr addr, const uint8_t *mac_addr, uint16_t state)
+{
+    struct ndmsg ndm = {
+        .ndm_family = AF_INET,
+        .ndm_ifindex = ifindex,
+        .ndm_state = state,
+    };
+    char addr_str[INET_ADDRSTRLEN];
+    union nl_req req;
+
+    nl_msg_init(&req.n, RTM_NEWNEIGH, NLM_F_CREATE | NLM_F_REPLACE,
+            &ndm, sizeof(ndm));
+    if (!nl_attr_put(&req.n, NDA_DST, &addr, sizeof(addr)) ||
+            !nl_attr_put(&req.n, NDA_LLADDR, mac_addr, ETH_ALEN)) {
+        return false;
+    }
+
+    inet_ntop(AF_INET, &addr, addr_str, sizeof(addr_str));
+
+    return nl_batch_add(b, &req.n,
+            "neigh replace %s lladdr %02x:%02x:%02x:%02x:%02x:%02x dev %s nud %s",
+            addr_str, mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3],
+            mac_addr[4], mac_addr[5], ifname,
+            state == NUD_PERMANENT ? "permanent" : "reachable");
+}
+
+struct neigh_flush_ctx {
+    struct nl_batch *b;
+    const int *ifindexes;
+    int count;
+    bool ok;
+};
+
+static void neigh_flush_cb(const struct nlmsghdr *n, void *arg)
+{
+    struct neigh_flush_ctx *ctx = arg;
+    const struct ndmsg *ndm = NLMSG_DATA(n);
+    const struct rtattr *rta = (const struct rtattr *) ((const char *) ndm +
+            NLMSG_ALIGN(sizeof(*ndm)));
+    int len = n->nlmsg_len - NLMSG_LENGTH(sizeof(*ndm));
+    char addr_str[INET6_ADDRSTRLEN] = "?";
+    union nl_req req;
+    bool wanted = false;
+
+    /* same as 'ip neigh flush', static entries stay */
+    if (n->nlmsg_type != RTM_NEWNEIGH ||
+            ndm->ndm_state & (NUD_PERMANENT | NUD_NOARP)) {
+        return;
+    }
+
+    for (int i = 0; i < ctx->count; i++) {
+        wanted |= ndm->ndm_ifindex == ctx->ifindexes[i];
+    }
+    if (!wanted) {
+        return;
+    }
+
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == NDA_DST) {
+            inet_ntop(ndm->ndm_family, RTA_DATA(rta),
+                    addr_str, sizeof(addr_str));
+        }
+    }
+
+    if (n->nlmsg_len > NL_MSG_SIZE) {
+        WARN("not removing neighbour %s on ifindex %d, its dump entry is "
+                "%u bytes", addr_str, ndm->ndm_ifindex, n->nlmsg_len);
+        return;
+    }
+    memcpy(&req, n, n->nlmsg_len);
+    req.n.nlmsg_type = RTM_DELNEIGH;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+
+    if (!nl_batch_add(ctx->b, &req.n, "neigh del %s ifindex %d",
+                addr_str, ndm->ndm_ifindex)) {
+        ctx->ok = false;
+    }
+}
+
+/*
+ * Queue a delete for every dynamic neighbour entry on the given
+ * interfaces, like 'ip neigh flush dev' for each of them. Entries on
+ * other interfaces are left alone.
+ */
+bool nl_neigh_flush(struct nl_batch *b, const int *ifindexes, int count)
+{
+    struct ndmsg ndm = { .ndm_family = AF_UNSPEC };
+    struct neigh_flush_ctx ctx = { b, ifindexes, count, true };
+
+    if (!count) {
+        return true;
+    }
+
+    if (!nl_dump(b, RTM_GETNEIGH, &ndm, sizeof(ndm), neigh_flush_cb, &ctx)) {
+        return false;
+    }
+
+    return ctx.ok;
+}
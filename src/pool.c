@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* local includes */
+#include "debug.h"
+#include "pool.h"
+
+struct pool {
+    size_t count;
+    size_t next;
+    pool_fn fn;
+    void *arg;
+    struct debug_sink *sink;
+};
+
+static void *pool_worker(void *data)
+{
+    struct pool *pool = data;
+    size_t idx;
+
+    /* workers log wherever the thread that started them does */
+    debug_sink = pool->sink;
+
+    while ((idx = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) <
+            pool->count) {
+        pool->fn(idx, pool->arg);
+    }
+
+    return NULL;
+}
+
+/*
+ * Call fn once for every index in [0, count) from up to 'threads' worker
+ * threads. Returns when every call has completed. Falls back to running
+ * on the calling thread if no workers could be started.
+ */
+void pool_run(size_t count, int threads, pool_fn fn, void *arg)
+{
+    struct pool pool = {
+        .count = count,
+        .next = 0,
+        .fn = fn,
+        .arg = arg,
+        .sink = debug_sink,
+    };
+    pthread_t tids[POOL_MAX_THREADS];
+    int started = 0;
+
+    if (threads > POOL_MAX_THREADS) {
+        threads = POOL_MAX_THREADS;
+    }
+    if ((size_t) threads > count) {
+        threads = count;
+    }
+
+    for (int i = 0; i < threads - 1; i++) {
+        int err = pthread_create(&tids[i], NULL, pool_worker, &pool);
+
+        if (err) {
+            WARN("unable to start worker thread: %s", strerror(err));
+            break;
+        }
+        started++;
+    }
+
+    /* the calling thread picks up work too */
+    pool_worker(&pool);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+}
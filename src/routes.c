@@ -0,0 +1,357 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <linux/rtnetlink.h>
+
+/* local includes */
+#include "debug.h"
+#include "routes.h"
+#include "utils.h"
+
+/* what a line left to 'ip route' may contain, it goes through the shell */
+#define ROUTE_IP_CHARS "abcdefghijklmnopqrstuvwxyz" \
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 \t./:_-"
+
+/* the options parse_route() turns into netlink attributes itself */
+static const char *route_options[] = {
+    "dev", "metric", "oif", "onlink", "preference", "priority", "proto",
+    "protocol", "scope", "src", "via",
+};
+
+static const struct {
+    const char *name;
+    uint8_t value;
+} route_protos[] = {
+    { "kernel", RTPROT_KERNEL },
+    { "boot",   RTPROT_BOOT },
+    { "static", RTPROT_STATIC },
+}, route_scopes[] = {
+    { "host",     RT_SCOPE_HOST },
+    { "link",     RT_SCOPE_LINK },
+    { "global",   RT_SCOPE_UNIVERSE },
+    { "universe", RT_SCOPE_UNIVERSE },
+};
+
+static bool parse_u32(const char *str, uint32_t *val)
+{
+    unsigned long num;
+    char *end;
+
+    errno = 0;
+    num = strtoul(str, &end, 0);
+
+    if (errno || end == str || *end || num > UINT32_MAX) {
+        return false;
+    }
+    *val = num;
+
+    return true;
+}
+
+/* a name from the table, or a plain number up to 255 */
+#define parse_named(table, str, val) \
+    parse_named_u8(table, sizeof(table) / sizeof(table[0]), str, val)
+
+static bool parse_named_u8(const void *table, int count, const char *str,
+        uint8_t *val)
+{
+    const struct { const char *name; uint8_t value; } *names = table;
+    uint32_t num;
+
+    for (int i = 0; i < count; i++) {
+        if (!strcmp(names[i].name, str)) {
+            *val = names[i].value;
+            return true;
+        }
+    }
+
+    if (!parse_u32(str, &num) || num > UINT8_MAX) {
+        return false;
+    }
+    *val = num;
+
+    return true;
+}
+
+static bool parse_prefix(const char *str, struct nl_route *r)
+{
+    char addr[INET_ADDRSTRLEN];
+    const char *slash;
+    uint32_t len = 32;
+
+    if (!strcmp(str, "default")) {
+        r->dst.s_addr = 0;
+        r->dst_len = 0;
+        return true;
+    }
+
+    slash = strchr(str, '/');
+    if (slash) {
+        if (slash - str >= sizeof(addr) || !parse_u32(slash + 1, &len) ||
+                len > 32) {
+            return false;
+        }
+        strlcpy(addr, str, slash - str + 1);
+    } else if (strlen(str) < sizeof(addr)) {
+        strlcpy(addr, str, sizeof(addr));
+    } else {
+        return false;
+    }
+
+    if (inet_pton(AF_INET, addr, &r->dst) != 1) {
+        return false;
+    }
+    r->dst_len = len;
+
+    return true;
+}
+
+static bool route_option_known(const char *tok)
+{
+    for (size_t i = 0; i < sizeof(route_options) / sizeof(route_options[0]);
+            i++) {
+        if (!strcmp(route_options[i], tok)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * A line with a route type or option parse_route() does not know, such
+ * as blackhole, mtu or nexthop, is kept as written and later run as
+ * 'ip route replace table <table> <line> src <address>'. That is how
+ * every line was applied before the file was parsed here.
+ */
+static bool route_keep_line(const char *raw, const char *path, int lineno,
+        const char *tok, struct route_entry *e)
+{
+    char copy[ROUTE_LINE_SIZE];
+    char *save = NULL;
+    char *cp;
+
+    strlcpy(copy, raw, sizeof(copy));
+    for (cp = strtok_r(copy, " \t", &save); cp;
+            cp = strtok_r(NULL, " \t", &save)) {
+        if (!strcmp(cp, "src")) {
+            WARN("%s:%d: skipping route due to source address routing constraints",
+                    path, lineno);
+            return false;
+        }
+        if (!strcmp(cp, "table")) {
+            WARN("%s:%d: the table belongs to the device, skipping", path,
+                    lineno);
+            return false;
+        }
+    }
+
+    if (raw[strspn(raw, ROUTE_IP_CHARS)]) {
+        WARN("%s:%d: unexpected characters in route, skipping", path, lineno);
+        return false;
+    }
+
+    e->ip_args = strdup(raw + strspn(raw, " \t"));
+    if (!e->ip_args) {
+        ERROR("could not allocate route list");
+        return false;
+    }
+
+    VERBOSE("%s:%d: '%s' is left to ip route", path, lineno, tok);
+
+    return true;
+}
+
+/*
+ * One route in 'ip route' syntax, without the table and source address.
+ * Returns false with a warning when the line should be skipped.
+ */
+static bool parse_route(char *line, const char *path, int lineno,
+        struct route_entry *e)
+{
+    struct nl_route *r = &e->route;
+    char raw[ROUTE_LINE_SIZE];
+    bool scope_set = false;
+    char *save = NULL;
+    char *tok, *arg;
+    uint32_t num;
+
+    memset(e, 0, sizeof(*e));
+    e->line = lineno;
+    r->protocol = RTPROT_BOOT;
+
+    strlcpy(raw, line, sizeof(raw));
+
+    tok = strtok_r(line, " \t", &save);
+    if (tok && !strcmp(tok, "unicast")) {
+        tok = strtok_r(NULL, " \t", &save);
+    } else if (tok && isalpha((unsigned char) tok[0]) &&
+            strcmp(tok, "default")) {
+        /* blackhole, unreachable and the other route types */
+        return route_keep_line(raw, path, lineno, tok, e);
+    }
+    if (!tok || !parse_prefix(tok, r)) {
+        WARN("%s:%d: invalid destination '%s', skipping", path, lineno,
+                tok ? tok : "");
+        return false;
+    }
+
+    while ((tok = strtok_r(NULL, " \t", &save))) {
+        if (!strcmp(tok, "onlink")) {
+            r->flags |= RTNH_F_ONLINK;
+            continue;
+        }
+
+        if (!route_option_known(tok)) {
+            return route_keep_line(raw, path, lineno, tok, e);
+        }
+
+        arg = strtok_r(NULL, " \t", &save);
+        if (!arg) {
+            WARN("%s:%d: '%s' needs an argument, skipping", path, lineno, tok);
+            return false;
+        }
+
+        if (!strcmp(tok, "src")) {
+            /* the source address belongs to the device, not the file */
+            WARN("%s:%d: skipping route due to source address routing constraints",
+                    path, lineno);
+            return false;
+        } else if (!strcmp(tok, "via")) {
+            if (!strcmp(arg, "inet")) {
+                arg = strtok_r(NULL, " \t", &save);
+            }
+            if (!arg || inet_pton(AF_INET, arg, &r->gateway) != 1) {
+                WARN("%s:%d: invalid gateway, skipping", path, lineno);
+                return false;
+            }
+        } else if (!strcmp(tok, "dev") || !strcmp(tok, "oif")) {
+            if (strlen(arg) >= sizeof(e->ifname)) {
+                WARN("%s:%d: invalid device '%s', skipping", path, lineno, arg);
+                return false;
+            }
+            strlcpy(e->ifname, arg, sizeof(e->ifname));
+        } else if (!strcmp(tok, "metric") || !strcmp(tok, "preference") ||
+                !strcmp(tok, "priority")) {
+            if (!parse_u32(arg, &num)) {
+                WARN("%s:%d: invalid metric '%s', skipping", path, lineno, arg);
+                return false;
+            }
+            r->priority = num;
+        } else if (!strcmp(tok, "proto") || !strcmp(tok, "protocol")) {
+            if (!parse_named(route_protos, arg, &r->protocol)) {
+                WARN("%s:%d: invalid protocol '%s', skipping", path, lineno, arg);
+                return false;
+            }
+        } else if (!strcmp(tok, "scope")) {
+            if (!parse_named(route_scopes, arg, &r->scope)) {
+                WARN("%s:%d: invalid scope '%s', skipping", path, lineno, arg);
+                return false;
+            }
+            scope_set = true;
+        }
+    }
+
+    /* same default as 'ip route', directly connected without a gateway */
+    if (!scope_set) {
+        r->scope = r->gateway.s_addr ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK;
+    }
+
+    return true;
+}
+
+/*
+ * Read a route file, one route per line in 'ip route' syntax. Blank
+ * lines and '#' comments are ignored, routes that cannot be used are
+ * skipped with a warning. Only a file that cannot be read is an error.
+ *
+ * Parsed into netlink requests: a destination (prefix, address or
+ * default, optionally after 'unicast') with via, dev/oif, metric/
+ * preference/priority, proto/protocol, scope and onlink. Any other
+ * route type or option leaves the line to 'ip route', see
+ * route_keep_line().
+ */
+bool route_file_load(const char *path, struct route_entry **entries,
+        int *count)
+{
+    char line[ROUTE_LINE_SIZE];
+    struct route_entry *list = NULL;
+    struct route_entry *tmp;
+    int n = 0, lineno = 0;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        ERROR("Unable to open route file %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (!line[strspn(line, " \t")]) {
+            continue;
+        }
+
+        tmp = realloc(list, (n + 1) * sizeof(*list));
+        if (!tmp) {
+            ERROR("could not allocate route list");
+            route_file_free(list, n);
+            fclose(fp);
+            return false;
+        }
+        list = tmp;
+
+        if (parse_route(line, path, lineno, &list[n])) {
+            n++;
+        }
+    }
+
+    fclose(fp);
+
+    DEBUG("%d routes read from %s", n, path);
+
+    *entries = list;
+    *count = n;
+
+    return true;
+}
+
+void route_file_free(struct route_entry *entries, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(entries[i].ip_args);
+    }
+    free(entries);
+}
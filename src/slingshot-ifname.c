@@ -0,0 +1,370 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <glob.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/* local includes */
+#include "debug.h"
+
+#define SYSFS_ROOT  "/sys"
+#define CACHE_FILE  "/run/slingshot-ifname.cache"
+#define CACHE_MAGIC "slingshot-ifname 1"
+
+#define PCI_PATTERN "????:??:??.?"
+#define HSN_PREFIX  "hsn"
+#define ATTR_SIZE   32
+
+#define NETWORK_CLASS     "0x020000"
+#define VENDOR_MELLANOX   "0x15b3"
+#define DEVICE_CONNECTX_5 "0x1017"
+
+/*
+ * The ConnectX-5 PCI functions, relative to <root>/devices and in the
+ * order slingshot-ifname.sh walks them. Whether each one has a network
+ * interface yet is checked at lookup time, as udev names them one by one.
+ */
+struct hsn_devs {
+    char **paths;
+    int count;
+};
+
+/* usage */
+static void usage_brief(const char *prog, FILE *fp)
+{
+    fprintf(fp, "Usage: %s [-h|--help] [-c|--cache <file>] [-s|--sysfs-root <dir>] <netif>\n",
+            prog);
+}
+
+static void usage_full(const char *prog, FILE *fp)
+{
+    usage_brief(prog, fp);
+
+    fprintf(fp, "\n");
+
+    fprintf(fp, "\t-h|--help              show this helpful text\n");
+    fprintf(fp, "\t-c|--cache <file>      where the PCI scan is kept between calls (default: %s)\n",
+            CACHE_FILE);
+    fprintf(fp, "\t-s|--sysfs-root <dir>  where sysfs is mounted (default: %s)\n",
+            SYSFS_ROOT);
+    fprintf(fp, "\t<netif>                the kernel name of the interface, the name it should\n");
+    fprintf(fp, "\t                       have is printed\n");
+}
+
+static void hsn_devs_free(struct hsn_devs *devs)
+{
+    for (int i = 0; i < devs->count; i++) {
+        free(devs->paths[i]);
+    }
+    free(devs->paths);
+    devs->paths = NULL;
+    devs->count = 0;
+}
+
+static void hsn_devs_add(struct hsn_devs *devs, const char *path)
+{
+    char **paths;
+
+    paths = realloc(devs->paths, (devs->count + 1) * sizeof(*paths));
+    if (!paths) {
+        FATAL("could not allocate device list");
+    }
+    devs->paths = paths;
+
+    paths[devs->count] = strdup(path);
+    if (!paths[devs->count]) {
+        FATAL("could not allocate device list");
+    }
+    devs->count++;
+}
+
+static bool hsn_devs_equal(const struct hsn_devs *a, const struct hsn_devs *b)
+{
+    if (a->count != b->count) {
+        return false;
+    }
+    for (int i = 0; i < a->count; i++) {
+        if (strcmp(a->paths[i], b->paths[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool read_attr(const char *dir, const char *name, char *buf)
+{
+    char path[PATH_MAX];
+    FILE *fp;
+    bool ok;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+
+    ok = fgets(buf, ATTR_SIZE, fp) != NULL;
+    if (ok) {
+        buf[strcspn(buf, "\n")] = '\0';
+    }
+
+    fclose(fp);
+
+    return ok;
+}
+
+static int path_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/* every PCI function one or two levels down, sorted as 'ls' would */
+static void hsn_devs_scan(const char *root, struct hsn_devs *devs)
+{
+    char pattern[PATH_MAX], class[ATTR_SIZE], vendor[ATTR_SIZE];
+    char device[ATTR_SIZE];
+    size_t skip;
+    glob_t gl;
+
+    snprintf(pattern, sizeof(pattern), "%s/devices/pci*/" PCI_PATTERN, root);
+    glob(pattern, GLOB_NOSORT, NULL, &gl);
+    snprintf(pattern, sizeof(pattern),
+            "%s/devices/pci*/" PCI_PATTERN "/" PCI_PATTERN, root);
+    glob(pattern, GLOB_NOSORT | GLOB_APPEND, NULL, &gl);
+
+    qsort(gl.gl_pathv, gl.gl_pathc, sizeof(*gl.gl_pathv), path_cmp);
+
+    skip = strlen(root) + strlen("/devices/");
+
+    for (size_t i = 0; i < gl.gl_pathc; i++) {
+        const char *dir = gl.gl_pathv[i];
+
+        if (!read_attr(dir, "class", class) ||
+                !read_attr(dir, "vendor", vendor) ||
+                !read_attr(dir, "device", device)) {
+            continue;
+        }
+
+        if (!strcmp(class, NETWORK_CLASS) &&
+                !strcmp(vendor, VENDOR_MELLANOX) &&
+                !strcmp(device, DEVICE_CONNECTX_5)) {
+            DEBUG("ConnectX-5 at %s", dir + skip);
+            hsn_devs_add(devs, dir + skip);
+        }
+    }
+
+    globfree(&gl);
+}
+
+static bool hsn_devs_load(const char *cache, const char *root,
+        struct hsn_devs *devs)
+{
+    char line[PATH_MAX];
+    char magic[PATH_MAX];
+    FILE *fp;
+
+    fp = fopen(cache, "r");
+    if (!fp) {
+        return false;
+    }
+
+    /* a cache of another sysfs root does not count */
+    snprintf(magic, sizeof(magic), "%s %s\n", CACHE_MAGIC, root);
+    if (!fgets(line, sizeof(line), fp) || strcmp(line, magic)) {
+        fclose(fp);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0]) {
+            hsn_devs_add(devs, line);
+        }
+    }
+
+    fclose(fp);
+
+    return true;
+}
+
+/* written whole and renamed into place, udev runs us in parallel */
+static void hsn_devs_save(const char *cache, const char *root,
+        const struct hsn_devs *devs)
+{
+    char tmp[PATH_MAX];
+    FILE *fp;
+    int fd;
+
+    if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", cache) >= (int) sizeof(tmp)) {
+        return;
+    }
+
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        DEBUG("Unable to create %s, not caching", tmp);
+        return;
+    }
+
+    fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        unlink(tmp);
+        return;
+    }
+
+    fprintf(fp, "%s %s\n", CACHE_MAGIC, root);
+    for (int i = 0; i < devs->count; i++) {
+        fprintf(fp, "%s\n", devs->paths[i]);
+    }
+
+    if (fclose(fp) || rename(tmp, cache)) {
+        DEBUG("Unable to write %s, not caching", cache);
+        unlink(tmp);
+    }
+}
+
+/*
+ * The index of netif among the ConnectX-5 functions that have a network
+ * interface, or -1. A function with more than one interface still takes
+ * an index, but none of its interfaces are renamed.
+ */
+static int hsn_index(const char *root, const struct hsn_devs *devs,
+        const char *netif)
+{
+    char dir[PATH_MAX], pattern[PATH_MAX + 8];
+    const char *name;
+    int index = -1;
+    bool found;
+    glob_t gl;
+
+    for (int i = 0; i < devs->count; i++) {
+        snprintf(dir, sizeof(dir), "%s/devices/%s", root, devs->paths[i]);
+
+        snprintf(pattern, sizeof(pattern), "%s/net", dir);
+        if (access(pattern, R_OK)) {
+            continue;
+        }
+        index++;
+
+        snprintf(pattern, sizeof(pattern), "%s/net/*", dir);
+        glob(pattern, GLOB_NOSORT, NULL, &gl);
+        snprintf(pattern, sizeof(pattern), "%s/*/net/*", dir);
+        glob(pattern, GLOB_NOSORT | GLOB_APPEND, NULL, &gl);
+
+        found = false;
+        if (gl.gl_pathc == 1) {
+            name = strrchr(gl.gl_pathv[0], '/') + 1;
+            found = !strcmp(name, netif);
+        }
+
+        globfree(&gl);
+
+        if (found) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/* driver */
+int main(int argc, char *argv[])
+{
+    const char *root = SYSFS_ROOT;
+    const char *cache = CACHE_FILE;
+    struct hsn_devs cached = { NULL, 0 };
+    struct hsn_devs scanned = { NULL, 0 };
+    bool have_cache;
+    int index = -1;
+    int opt;
+
+    while (1) {
+        const struct option long_options[] = {
+            {"help",       no_argument, NULL, 'h'},
+            {"cache",      required_argument, NULL, 'c'},
+            {"sysfs-root", required_argument, NULL, 's'},
+            { }
+        };
+
+        opt = getopt_long(argc, argv, "c:hs:", long_options, NULL);
+        if (opt == -1)
+            break;
+
+        switch (opt) {
+            case 'h':
+                usage_full(argv[0], stdout);
+                return EXIT_SUCCESS;
+            case 'c':
+                cache = optarg;
+                break;
+            case 's':
+                root = optarg;
+                break;
+            case '?':
+                usage_brief(argv[0], stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 1) {
+        usage_brief(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+
+    have_cache = hsn_devs_load(cache, root, &cached);
+    if (have_cache) {
+        index = hsn_index(root, &cached, argv[optind]);
+    }
+
+    /* not in the cache, it may be older than the device */
+    if (index < 0) {
+        hsn_devs_scan(root, &scanned);
+        index = hsn_index(root, &scanned, argv[optind]);
+        if (!have_cache || !hsn_devs_equal(&cached, &scanned)) {
+            hsn_devs_save(cache, root, &scanned);
+        }
+    }
+
+    if (index < 0) {
+        printf("%s\n", argv[optind]);
+    } else {
+        printf("%s%d\n", HSN_PREFIX, index);
+    }
+
+    hsn_devs_free(&cached);
+    hsn_devs_free(&scanned);
+
+    return EXIT_SUCCESS;
+}
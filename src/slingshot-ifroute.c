@@ -0,0 +1,712 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/file.h>
+#include <linux/rtnetlink.h>
+
+/* local includes */
+#include "debug.h"
+#include "netlink.h"
+#include "routes.h"
+#include "utils.h"
+
+#define LOCK_FILE          "/var/lock/slingshot-ifroute.lock"
+#define RT_TABLES          "/etc/iproute2/rt_tables"
+#define RT_TABLES_FALLBACK "/usr/share/iproute2/rt_tables"
+#define SYSCTL_CONF_DIR    "/proc/sys/net/ipv4/conf"
+
+#define DEV_PREFIX "hsn"
+#define RT_PREFIX  "rt_"
+
+#define RT_TABLE_BASE 200
+#define LINE_SIZE     256
+#define VALUE_SIZE    32
+#define PATH_SIZE     256
+
+/* rule preferences, lower is looked at first */
+#define LOCAL_LOOPBACK_PREF       0
+#define OUTBOUND_LOC_DEVICE_PREF  1
+#define OUTBOUND_REM_DEVICE_PREF  2
+#define LOCAL_TABLE_PREF          10
+
+/* what the device needs, worked out before anything is queued */
+struct ifroute_dev {
+    const char *ifname;
+    int ifindex;
+    uint32_t table;
+    struct in_addr addr;
+    int prefix;
+};
+
+/* everything the kernel had when we started, plus what we queued since */
+struct ifroute_state {
+    struct nl_rule *rules;
+    int nrules;
+    struct nl_route *routes;
+    int nroutes;
+};
+
+static const struct {
+    const char *key;
+    const char *value;
+} ifroute_sysctls[] = {
+    { "accept_local", "1" },
+    { "arp_accept",   "1" },
+    { "arp_ignore",   "1" },
+    { "arp_filter",   "1" },
+    { "arp_announce", "2" },
+    { "rp_filter",    "0" },
+};
+
+static bool dry_run;
+
+/* usage */
+static void usage_brief(const char *prog, FILE *fp)
+{
+    fprintf(fp, "Usage: %s [-h|--help] [-d|--debug] [-n|--dry-run] [-v|--verbose] "
+            "\n\t\t[-r|--route-file <file>] [-t|--rt-tables <file>] "
+            "[<interface> <status>]\n", prog);
+}
+
+static void usage_full(const char *prog, FILE *fp)
+{
+    usage_brief(prog, fp);
+
+    fprintf(fp, "\n");
+
+    fprintf(fp, "\t-h|--help              show this helpful text\n");
+    fprintf(fp, "\t-d|--debug             enable debug output\n");
+    fprintf(fp, "\t-n|--dry-run           show the changes to be made but do not make them\n");
+    fprintf(fp, "\t-r|--route-file <file> add the routes in file, one per line in 'ip route'\n");
+    fprintf(fp, "\t                       syntax, to the table of every interface\n");
+    fprintf(fp, "\t-t|--rt-tables <file>  iproute2 routing table names (default: %s)\n",
+            RT_TABLES);
+    fprintf(fp, "\t-v|--verbose           enable verbose output\n");
+    fprintf(fp, "\t<interface>            the interfaces to route, as a name, a comma separated\n");
+    fprintf(fp, "\t                       list or a range such as hsn[0-7] (default: every HSN)\n");
+    fprintf(fp, "\t<status>               interface status (e.g. up), required with <interface>\n");
+}
+
+/* serialize with other instances, as the dispatcher may start several */
+static int ifroute_lock(void)
+{
+    int fd;
+
+    fd = open(LOCK_FILE, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        WARN("Unable to open %s: %s", LOCK_FILE, strerror(errno));
+        return -1;
+    }
+
+    if (flock(fd, LOCK_EX | LOCK_NB)) {
+        WARN("Another slingshot-ifroute instance is running. Waiting for it to finish...");
+        if (flock(fd, LOCK_EX)) {
+            WARN("Unable to lock %s: %s", LOCK_FILE, strerror(errno));
+        }
+    }
+
+    return fd;
+}
+
+static const char *find_rt_tables(void)
+{
+    if (!access(RT_TABLES, F_OK)) {
+        return RT_TABLES;
+    }
+    if (!access(RT_TABLES_FALLBACK, F_OK)) {
+        return RT_TABLES_FALLBACK;
+    }
+
+    return NULL;
+}
+
+/*
+ * Look up the rt_<dev> table for each device, adding the missing ones
+ * as 200 + unit. Labels have to match exactly, so rt_hsn1 does not
+ * count as a second entry for rt_hsn10.
+ */
+static bool load_rt_tables(const char *rt_tables, struct ifroute_dev *devs,
+        int count)
+{
+    char line[LINE_SIZE], label[LINE_SIZE];
+    int *found;
+    unsigned int id;
+    bool ok = true;
+    FILE *fp;
+
+    found = calloc(count, sizeof(*found));
+    if (!found) {
+        FATAL("could not allocate table lookup");
+    }
+
+    fp = fopen(rt_tables, "r");
+    if (!fp) {
+        ERROR("Unable to open %s: %s", rt_tables, strerror(errno));
+        ok = false;
+        goto free_found;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, " %u %255s", &id, label) != 2 ||
+                strncmp(label, RT_PREFIX, strlen(RT_PREFIX))) {
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            if (!strcmp(label + strlen(RT_PREFIX), devs[i].ifname)) {
+                devs[i].table = id;
+                found[i]++;
+            }
+        }
+    }
+
+    fclose(fp);
+
+    fp = NULL;
+    for (int i = 0; ok && i < count; i++) {
+        const char *unit = devs[i].ifname;
+
+        if (found[i] > 1) {
+            ERROR("Multiple entries found for %s%s in %s",
+                    RT_PREFIX, devs[i].ifname, rt_tables);
+            ok = false;
+            break;
+        }
+        if (found[i]) {
+            VERBOSE("%s%s already exists: %u", RT_PREFIX, devs[i].ifname,
+                    devs[i].table);
+            continue;
+        }
+
+        if (!strncmp(unit, DEV_PREFIX, strlen(DEV_PREFIX))) {
+            unit += strlen(DEV_PREFIX);
+        }
+        devs[i].table = RT_TABLE_BASE + atoi(unit);
+
+        VERBOSE("adding entry for %s%s in %s", RT_PREFIX, devs[i].ifname,
+                rt_tables);
+        if (dry_run) {
+            continue;
+        }
+
+        if (!fp) {
+            fp = fopen(rt_tables, "a");
+            if (!fp) {
+                ERROR("Unable to update %s: %s", rt_tables, strerror(errno));
+                ok = false;
+                break;
+            }
+        }
+        fprintf(fp, "%u %s%s\n", devs[i].table, RT_PREFIX, devs[i].ifname);
+    }
+
+    if (fp && fclose(fp)) {
+        ERROR("Unable to update %s: %s", rt_tables, strerror(errno));
+        ok = false;
+    }
+
+free_found:
+    free(found);
+
+    return ok;
+}
+
+/* same rule apart from the preference, as 'ip rule | grep' would see it */
+static bool rule_matches(const struct nl_rule *a, const struct nl_rule *b)
+{
+    return a->table == b->table &&
+        a->src_len == b->src_len &&
+        (!a->src_len || a->src.s_addr == b->src.s_addr) &&
+        a->dst_len == b->dst_len &&
+        (!a->dst_len || a->dst.s_addr == b->dst.s_addr) &&
+        !strcmp(a->iifname, b->iifname);
+}
+
+static bool add_rule_if_not_present(struct nl_batch *b,
+        struct ifroute_state *state, const struct nl_rule *r)
+{
+    struct nl_rule *rules;
+
+    for (int i = 0; i < state->nrules; i++) {
+        if (rule_matches(&state->rules[i], r)) {
+            VERBOSE("rule from %s lookup %u is already present. skipping",
+                    inet_ntoa(r->src), r->table);
+            return true;
+        }
+    }
+
+    /* remember it, the same rule can come up for more than one device */
+    rules = realloc(state->rules, (state->nrules + 1) * sizeof(*rules));
+    if (!rules) {
+        FATAL("could not allocate rule list");
+    }
+    state->rules = rules;
+    state->rules[state->nrules++] = *r;
+
+    return nl_rule_add(b, r);
+}
+
+/* move the local table behind the per device rules */
+static bool fix_local_pref(struct nl_batch *b, struct ifroute_state *state)
+{
+    struct nl_rule local = {
+        .pref = LOCAL_TABLE_PREF,
+        .table = RT_TABLE_LOCAL,
+    };
+
+    for (int i = 0; i < state->nrules; i++) {
+        struct nl_rule *r = &state->rules[i];
+
+        if (!rule_matches(r, &local) || r->pref >= LOCAL_TABLE_PREF) {
+            continue;
+        }
+
+        if (!nl_rule_add(b, &local) || !nl_rule_del(b, r)) {
+            return false;
+        }
+        r->pref = LOCAL_TABLE_PREF;
+        break;
+    }
+
+    return true;
+}
+
+static bool route_present(const struct ifroute_state *state,
+        const struct nl_route *r)
+{
+    for (int i = 0; i < state->nroutes; i++) {
+        const struct nl_route *cur = &state->routes[i];
+
+        if (cur->table == r->table && cur->dst_len == r->dst_len &&
+                cur->dst.s_addr == r->dst.s_addr && cur->oif == r->oif &&
+                cur->gateway.s_addr == r->gateway.s_addr &&
+                cur->priority == r->priority &&
+                cur->protocol == r->protocol && cur->scope == r->scope &&
+                cur->prefsrc.s_addr == r->prefsrc.s_addr) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool get_dev_addr(struct nl_batch *b, struct ifroute_dev *dev)
+{
+    struct nl_link_state st;
+
+    dev->ifindex = if_nametoindex(dev->ifname);
+    if (!dev->ifindex || !nl_link_state_get(b, dev->ifindex, &st) ||
+            !st.naddrs) {
+        return false;
+    }
+
+    dev->addr = st.addrs[0].addr;
+    dev->prefix = st.addrs[0].prefix;
+
+    return true;
+}
+
+static bool queue_dev(struct nl_batch *b, struct ifroute_state *state,
+        const struct ifroute_dev *dev, char **targets, int ntargets)
+{
+    uint32_t mask = dev->prefix ? htonl(~0U << (32 - dev->prefix)) : 0;
+    struct nl_route route = {
+        .table = dev->table,
+        .dst.s_addr = dev->addr.s_addr & mask,
+        .dst_len = dev->prefix,
+        .protocol = RTPROT_KERNEL,
+        .scope = RT_SCOPE_HOST,
+        .oif = dev->ifindex,
+        .prefsrc = dev->addr,
+    };
+    struct nl_rule rule;
+
+    for (int i = 0; i < ntargets; i++) {
+        memset(&rule, 0, sizeof(rule));
+        rule.table = RT_TABLE_LOCAL;
+        rule.src = dev->addr;
+        rule.src_len = 32;
+
+        if (!strcmp(targets[i], dev->ifname)) {
+            rule.pref = LOCAL_LOOPBACK_PREF;
+            rule.dst = dev->addr;
+            rule.dst_len = 32;
+        } else {
+            rule.pref = OUTBOUND_LOC_DEVICE_PREF;
+            strlcpy(rule.iifname, targets[i], sizeof(rule.iifname));
+        }
+
+        if (!add_rule_if_not_present(b, state, &rule)) {
+            return false;
+        }
+    }
+
+    /* add local routing policy for outbound devices */
+    memset(&rule, 0, sizeof(rule));
+    rule.pref = OUTBOUND_REM_DEVICE_PREF;
+    rule.table = dev->table;
+    rule.src = dev->addr;
+    rule.src_len = 32;
+
+    if (!add_rule_if_not_present(b, state, &rule)) {
+        return false;
+    }
+
+    if (route_present(state, &route)) {
+        VERBOSE("route for %s in table %u is already present. skipping",
+                dev->ifname, dev->table);
+        return true;
+    }
+
+    return nl_route_replace(b, &route, dev->ifname);
+}
+
+/* the route file, in the device's table and from the device's address */
+static bool queue_dev_routes(struct nl_batch *b,
+        const struct ifroute_state *state, const struct ifroute_dev *dev,
+        const char *route_file, const struct route_entry *entries, int count)
+{
+    struct nl_route route;
+
+    for (int i = 0; i < count; i++) {
+        const struct route_entry *e = &entries[i];
+
+        if (e->ip_args) {
+            continue;
+        }
+
+        route = e->route;
+        route.table = dev->table;
+        route.prefsrc = dev->addr;
+
+        if (e->ifname[0]) {
+            route.oif = if_nametoindex(e->ifname);
+            if (!route.oif) {
+                WARN("%s:%d: no such device '%s', skipping", route_file,
+                        e->line, e->ifname);
+                continue;
+            }
+        }
+
+        if (route_present(state, &route)) {
+            DEBUG("%s:%d: already present in table %u", route_file, e->line,
+                    dev->table);
+            continue;
+        }
+
+        if (!nl_route_replace(b, &route, e->ifname[0] ? e->ifname : NULL)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* the lines route_file_load() left to 'ip route', after the batch */
+static bool run_dev_ip_routes(const struct ifroute_dev *dev,
+        const struct route_entry *entries, int count)
+{
+    char cmd[ROUTE_LINE_SIZE + 64];
+    char addr[INET_ADDRSTRLEN];
+    bool ok = true;
+
+    inet_ntop(AF_INET, &dev->addr, addr, sizeof(addr));
+
+    for (int i = 0; i < count; i++) {
+        if (!entries[i].ip_args) {
+            continue;
+        }
+
+        snprintf(cmd, sizeof(cmd), "ip route replace table %u %s src %s",
+                dev->table, entries[i].ip_args, addr);
+        ok &= run(cmd, dry_run);
+    }
+
+    return ok;
+}
+
+/* write a sysctl, unless it already has the value */
+static bool write_sysctl(const char *path, const char *value)
+{
+    char cur[VALUE_SIZE];
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (fp) {
+        if (fgets(cur, sizeof(cur), fp)) {
+            cur[strcspn(cur, "\n")] = '\0';
+        } else {
+            cur[0] = '\0';
+        }
+        fclose(fp);
+
+        if (!strcmp(cur, value)) {
+            DEBUG("%s is already %s", path, value);
+            return true;
+        }
+    }
+
+    VERBOSE("%s = %s", path, value);
+
+    if (dry_run) {
+        return true;
+    }
+
+    fp = fopen(path, "w");
+    if (!fp) {
+        ERROR("Unable to open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    fputs(value, fp);
+
+    if (fclose(fp)) {
+        ERROR("Unable to write %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+static bool set_dev_sysctls(const char *ifname)
+{
+    char path[PATH_SIZE];
+    bool ok = true;
+
+    for (int i = 0; i < sizeof(ifroute_sysctls) / sizeof(ifroute_sysctls[0]);
+            i++) {
+        snprintf(path, sizeof(path), "%s/%s/%s", SYSCTL_CONF_DIR, ifname,
+                ifroute_sysctls[i].key);
+        ok &= write_sysctl(path, ifroute_sysctls[i].value);
+    }
+
+    return ok;
+}
+
+/* driver */
+int main(int argc, char *argv[])
+{
+    const char *rt_tables = NULL;
+    const char *route_file = NULL;
+    struct route_entry *entries = NULL;
+    int nentries = 0;
+    struct ifroute_state state = { };
+    struct ifroute_dev *devs = NULL;
+    int *ifindexes = NULL;
+    int nifindexes = 0;
+    char *all_arg[] = { "all" };
+    char **ifnames = NULL;
+    char **targets = NULL;
+    int count = 0, ntargets = 0;
+    struct nl_batch b;
+    int ret = EXIT_FAILURE;
+    bool committed;
+    bool ok = true;
+    int lock_fd;
+    int opt;
+
+    while (1) {
+        const struct option long_options[] = {
+            {"help",      no_argument, NULL, 'h'},
+            {"debug",     no_argument, NULL, 'd'},
+            {"dry-run",   no_argument, NULL, 'n'},
+            {"route-file", required_argument, NULL, 'r'},
+            {"rt-tables", required_argument, NULL, 't'},
+            {"verbose",   no_argument, NULL, 'v'},
+            { }
+        };
+
+        opt = getopt_long(argc, argv, "dhnr:t:v", long_options, NULL);
+        if (opt == -1)
+            break;
+
+        switch (opt) {
+            case 'h':
+                usage_full(argv[0], stdout);
+                return EXIT_SUCCESS;
+            case 'd':
+                if (debug_default_sink.level > DEBUG_LVL_DEBUG)
+                    debug_default_sink.level = DEBUG_LVL_DEBUG;
+                break;
+            case 'n':
+                dry_run = true;
+                break;
+            case 'r':
+                route_file = optarg;
+                break;
+            case 't':
+                rt_tables = optarg;
+                break;
+            case 'v':
+                if (debug_default_sink.level > DEBUG_LVL_VERBOSE)
+                    debug_default_sink.level = DEBUG_LVL_VERBOSE;
+                break;
+            case '?':
+                usage_brief(argv[0], stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind == 1) {
+        ERROR("STATUS argument is missing for interface '%s'", argv[optind]);
+        usage_brief(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+    if (argc - optind > 2) {
+        usage_brief(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+
+    lock_fd = ifroute_lock();
+
+    if (!rt_tables) {
+        rt_tables = find_rt_tables();
+        if (!rt_tables) {
+            ERROR("iproute2 rt_tables not found");
+            goto unlock;
+        }
+    }
+
+    if (argc - optind) {
+        ifnames = expand_ifnames(1, argv + optind, &count);
+    } else {
+        VERBOSE("Running for all hsn interfaces");
+        ifnames = expand_ifnames(1, all_arg, &count);
+    }
+    if (!ifnames) {
+        ERROR("no interfaces to route");
+        goto free_ifnames;
+    }
+
+    /* no HSN interfaces at all just means no per target rules */
+    targets = expand_ifnames(1, all_arg, &ntargets);
+
+    devs = calloc(count, sizeof(*devs));
+    ifindexes = calloc(count, sizeof(*ifindexes));
+    if (!devs || !ifindexes) {
+        FATAL("could not allocate device list");
+    }
+    for (int i = 0; i < count; i++) {
+        devs[i].ifname = ifnames[i];
+    }
+
+    if (!load_rt_tables(rt_tables, devs, count)) {
+        goto free_devs;
+    }
+
+    /* parsed once, then applied to each device */
+    if (route_file && !route_file_load(route_file, &entries, &nentries)) {
+        goto free_devs;
+    }
+
+    if (!nl_batch_init(&b, dry_run)) {
+        goto free_devs;
+    }
+
+    /* one dump of each, everything after works from these */
+    if (!nl_rule_list(&b, &state.rules, &state.nrules) ||
+            !nl_route_list(&b, &state.routes, &state.nroutes)) {
+        ERROR("Unable to read routing policy");
+        goto free_batch;
+    }
+
+    ok = fix_local_pref(&b, &state);
+
+    for (int i = 0; ok && i < count; i++) {
+        if (!get_dev_addr(&b, &devs[i])) {
+            ERROR("Unable to determine IP or Mask for %s", devs[i].ifname);
+            continue;
+        }
+        ok = queue_dev(&b, &state, &devs[i], targets, ntargets) &&
+            queue_dev_routes(&b, &state, &devs[i], route_file,
+                    entries, nentries);
+    }
+
+    /* a half built policy is not sent, and neither is what follows it */
+    if (!ok) {
+        nl_batch_reset(&b);
+    } else if (nl_batch_commit(&b)) {
+        ok = false;
+    }
+    committed = ok;
+
+    for (int i = 0; committed && i < count; i++) {
+        if (devs[i].addr.s_addr) {
+            ok &= run_dev_ip_routes(&devs[i], entries, nentries);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        ok &= set_dev_sysctls(devs[i].ifname);
+    }
+
+    /*
+     * Only the neighbours of the interfaces being configured, other
+     * fabric interfaces keep theirs. There is no route cache to flush,
+     * the rule and route changes above already invalidate cached routes.
+     */
+    for (int i = 0; i < count; i++) {
+        if (devs[i].ifindex) {
+            ifindexes[nifindexes++] = devs[i].ifindex;
+        }
+    }
+    if (committed && (!nl_neigh_flush(&b, ifindexes, nifindexes) ||
+                nl_batch_commit(&b))) {
+        ok = false;
+    }
+
+    if (ok) {
+        ret = EXIT_SUCCESS;
+    }
+
+free_batch:
+    free(state.rules);
+    free(state.routes);
+    nl_batch_free(&b);
+free_devs:
+    route_file_free(entries, nentries);
+    free(ifindexes);
+    free(devs);
+free_ifnames:
+    free_ifnames(targets, ntargets);
+    free_ifnames(ifnames, count);
+unlock:
+    if (lock_fd >= 0) {
+        close(lock_fd);
+    }
+
+    return ret;
+}
@@ -34,351 +34,26 @@
 
 /* local includes */
 #include "debug.h"
-#include "validation.h"
 #include "utils.h"
 #include "tlv.h"
-
-/* external library includes */
-#include "cJSON.h"
-
-/* global definitions */
-#define BUFSIZE       1000
-#define MAC_ADDR_SIZE 24
-#define IP_ADDR_SIZE  32
-#define MTU_SIZE      16
-#define TTL_SIZE      16
-
-#define DEVICE_NOT_UP "Device not found or inactive"
-
-/* macros */
-#define ALLOC_CMD_BUFFER(cmds, idx, err_label, fmt, args...) \
-    do { \
-        cmds[idx] = calloc(BUFSIZE, sizeof(char)); \
-        if (!cmds[idx]) { \
-            goto err_label; \
-        } \
-        snprintf(cmds[idx], BUFSIZE * sizeof(char), \
-            fmt, ##args); \
-        idx++; \
-    } while (0)
-
-/* structs */
-struct program_options {
-    bool create_ifcfg;
-    bool dry_run;
-    bool remove_ip_addrs;
-    char *input_file;
-    bool skip_reload;
-};
-
-typedef struct fabric_config {
-    char *ifname;
-    char mac_addr[MAC_ADDR_SIZE];
-    char ip_addr[IP_ADDR_SIZE];
-    char mtu[MTU_SIZE];
-    char ttl[TTL_SIZE];
-} fabric_config_t;
-
-/* forward declarations */
-bool reload_interface(fabric_config_t *fc);
-
-/* global variables */
-struct program_options options = {
-    .create_ifcfg = false,
-    .dry_run = false,
-    .remove_ip_addrs = false,
-    .skip_reload = false,
-};
-
-char *get_lldp_tlv(fabric_config_t *fc) {
-    char buf[BUFSIZE];
-    char *org_tlv;
-    FILE *fp;
-
-    org_tlv = calloc(BUFSIZE, sizeof(*org_tlv));
-    if (!org_tlv) {
-        ERROR("failed to allocate memory for TLV data");
-        goto error;
-    }
-
-    snprintf(buf, sizeof(buf), "lldptool get-tlv -i %s -n", fc->ifname);
-
-    if (!options.input_file) {
-    fp = popen(buf, "r");
-    if (!fp) {
-        ERROR("opening pipe to lldptool failed!");
-        goto free_tlv;
-    }
-    } else {
-        fp = fopen(options.input_file, "r");
-    }
-
-    while (fgets(buf, sizeof(buf), fp)) {
-        /* Process output of lldptool (now in buf) */
-        chomp(buf);
-
-        DEBUG("%s", buf);
-
-        /* read MAC data from non-org TLV and store it */
-        if (!fc->mac_addr[0] && !strncmp(buf, "\tMAC: ", 6)) {
-            parse_mac_addr(buf, fc->mac_addr);
-        }
-
-        /* read org TLV */
-        if (!org_tlv[0] && !strncmp(buf, "\tOUI: ", 6)) {
-            parse_org_tlv(buf, org_tlv);
-        }
-
-        if (!strncmp(buf, DEVICE_NOT_UP, strlen(DEVICE_NOT_UP))) {
-            ERROR("device not found or inactive according to lldp");
-            DIAG("check local adapter state. The adapter may be down");
-            DIAG("carrier signal may also be absent.");
-            pclose(fp);
-            goto free_tlv;
-        }
-    } /* end while */
-
-    if (pclose(fp)) {
-        ERROR("lldptool exited with error status");
-        goto free_tlv;
-    }
-
-    if (!strlen(fc->mac_addr)) {
-        ERROR("lldpad not receiving any data from switch");
-        DIAG("check local LLDPAD configuration for administrative status");
-        DIAG("check Rosetta switch to see if it advertising TLVs on other adapters");
-        goto free_tlv;
-    }
-
-    if (!org_tlv[0]) {
-        ERROR("Missing Org TLV in lldptool output");
-        DIAG("check Rosetta switch configuration for LLDP. CrayTLV not advertised.");
-        DIAG("Fabric configuration is not active or not advertised");
-        goto free_tlv;
-    }
-
-    return org_tlv;
-
-free_tlv:
-    free(org_tlv);
-error:
-    return NULL;
-}
-
-bool is_valid_tlv_data(fabric_config_t *fc) {
-    VERBOSE("Parsed:");
-    VERBOSE("ifname:   %s", fc->ifname);
-    VERBOSE("mac_addr: %s", fc->mac_addr);
-    VERBOSE("ip_addr:  %s", fc->ip_addr);
-    VERBOSE("MTU:      %s", fc->mtu);
-    VERBOSE("TTL:      %s", fc->ttl);
-
-    /* Ensure that the items were parsed off as expected. */
-    if (!valid_mac_addr(fc->mac_addr)) {
-        ERROR("Invalid MAC addr: '%s'", fc->mac_addr);
-        DIAG("MAC address is malformed. Check LLDP output");
-        return false;
-    }
-
-    if (!valid_ip_addr(fc->ip_addr)) {
-        ERROR("Invalid IP addr: '%s'", fc->ip_addr);
-        DIAG("CrayTLV is malformed. Expected a valid IP address");
-        DIAG("Check Rosetta LLDP configuration");
-        return false;
-    }
-
-    if (!valid_mtu(fc->mtu)) {
-        ERROR("Invalid MTU: '%s'", fc->mtu);
-        DIAG("CrayTLV is malformed. Expected a valid MTU");
-        DIAG("Check Rosetta LLDP configuration");
-        return false;
-    }
-
-    if (!valid_ttl(fc->ttl)) {
-        ERROR("Invalid TTL: '%s'", fc->ttl);
-        DIAG("CrayTLV is malformed. Expected a valid TTL");
-        DIAG("Check Rosetta LLDP configuration");
-        return false;
-    }
-
-    return true;
-}
-
-bool parse_tlv(fabric_config_t *fc)
-{
-    char *org_tlv;
-
-    fc->mac_addr[0] = '\0';
-    fc->ip_addr[0] = '\0';
-    fc->mtu[0] = '\0';
-    fc->ttl[0] = '\0';
-
-    VERBOSE("Begin parse_tlv");
-
-    /* fetch TLV from LLDP */
-    org_tlv = get_lldp_tlv(fc);
-    if (!org_tlv) {
-        CRITICAL("failed to get response from LLDP, or "
-                    "could not find CrayTLV");
-        return false;
-    }
-
-    /* parse JSON payload from Org TLV */
-    DEBUG("Org TLV json: '%s'", org_tlv);
-    cJSON *org_json = cJSON_Parse(org_tlv);
-
-    /* free TLV string now that we are done with it */
-    free(org_tlv);
-
-    /* read json values from JSON object */
-    const cJSON *ip_addr_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "ip_addr");
-    if (cJSON_IsString(ip_addr_ptr)) {
-        strlcpy(fc->ip_addr, ip_addr_ptr->valuestring, IP_ADDR_SIZE);
-    }
-
-    const cJSON *mtu_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "mtu");
-    if (cJSON_IsNumber(mtu_ptr)) {
-        snprintf(fc->mtu, MTU_SIZE, "%d", mtu_ptr->valueint);
-    }
-
-    const cJSON *ttl_ptr = cJSON_GetObjectItemCaseSensitive(org_json, "ttl");
-    if (cJSON_IsNumber(ttl_ptr)) {
-        snprintf(fc->ttl, TTL_SIZE, "%d", ttl_ptr->valueint);
-    } else if (cJSON_IsString(ttl_ptr)) {
-        strlcpy(fc->ttl, ttl_ptr->valuestring, TTL_SIZE);
-    }
-
-    cJSON_Delete(org_json);
-
-    return is_valid_tlv_data(fc);
-}
-
-bool write_ifcfg(fabric_config_t *fc)
-{
-    char file[BUFSIZE];
-    FILE *fp;
-    bool ret = true;
-
-    if (!fc) {
-        FATAL("null fc passed to function");
-    }
-
-    snprintf(file, sizeof(file), "/etc/sysconfig/network/ifcfg-%s", fc->ifname);
-
-    if (options.dry_run) {
-        fp = stdout;
-        VERBOSE("open '%s' for writing", file);
-    } else {
-        fp = fopen(file, "w");
-        if (!fp) {
-            ERROR("Unable to create ifcfg file %s: %s", file, strerror(errno));
-            return false;
-        }
-    }
-
-    fprintf(fp, "NAME=%s\n", fc->ifname);
-    fprintf(fp, "STARTMODE=auto\n");
-    fprintf(fp, "BOOTPROTO=static\n");
-    fprintf(fp, "LLADDR=%s\n", fc->mac_addr);
-    fprintf(fp, "IPADDR=%s\n", fc->ip_addr);
-    fprintf(fp, "MTU=%s\n", fc->mtu);
-
-    /* What to do about ttl? */
-    fprintf(fp, "POST_UP_SCRIPT=wicked:/etc/sysconfig/network/if-up.d\n");
-
-    if (options.dry_run) {
-        VERBOSE("close");
-    } else {
-        fclose(fp);
-    }
-
-    if (!options.skip_reload) {
-        ret = reload_interface(fc);
-    }
-
-    return ret;
-}
-
-bool reload_interface(fabric_config_t *fc)
-{
-    char *commands[3] = {};
-    int index = 0;
-    bool result = false;
-
-    ALLOC_CMD_BUFFER(commands, index,
-            free_commands, "wicked ifdown %s", fc->ifname);
-    ALLOC_CMD_BUFFER(commands, index,
-            free_commands, "wicked ifup %s", fc->ifname);
-    commands[index] = NULL;
-
-    result = runv((const char **) commands, options.dry_run);
-
-    if (!result) {
-        ERROR("a command in the queue failed");
-    }
-
-free_commands:
-    for (int i = 0; i < 3; i++) {
-        if (commands[i])
-            free(commands[i]);
-    }
-
-    return result;
-}
-
-bool do_ip_cmds(fabric_config_t *fc)
-{
-    char *commands[7] = {};
-    int index = 0;
-    bool result = false;
-
-    if (options.remove_ip_addrs) {
-        ALLOC_CMD_BUFFER(commands, index, free_commands,
-                            "ip addr flush dev %s", fc->ifname);
-    }
-
-    if (!options.skip_reload) {
-        ALLOC_CMD_BUFFER(commands, index, free_commands,
-                            "ip link set dev %s down", fc->ifname);
-    }
-
-    ALLOC_CMD_BUFFER(commands, index, free_commands,
-                        "ip link set dev %s addr %s", fc->ifname, fc->mac_addr);
-
-    if (!options.skip_reload) {
-        ALLOC_CMD_BUFFER(commands, index, free_commands,
-                            "ip link set dev %s up", fc->ifname);
-    }
-
-    ALLOC_CMD_BUFFER(commands, index, free_commands,
-                        "ip addr add %s dev %s valid_lft %s preferred_lft %s",
-                        fc->ip_addr, fc->ifname, fc->ttl, fc->mtu);
-    ALLOC_CMD_BUFFER(commands, index, free_commands,
-                        "ip link set dev %s mtu %s", fc->ifname, fc->mtu);
-
-    commands[index] = NULL;
-
-    result = runv((const char **) commands, options.dry_run);
-
-    if (!result) {
-        ERROR("a command in the queue failed");
-    }
-
-free_commands:
-    for (int i = 0; i < 7; i++) {
-        if (commands[i])
-            free(commands[i]);
-    }
-
-    return result;
-}
+#include "trace.h"
+#include "cache.h"
+#include "hostmap.h"
+#include "metrics.h"
+#include "cfg_lldp.h"
+#include "slingshot-netcfg.h"
 
 /* usage */
 void usage_brief(const char *prog, FILE *fp)
 {
-    fprintf(fp, "Usage: %s [-h|--help] [-c|--create-ifcfg] [-d|--debug] "
-            "\n\t\t[-n|--dry-run] [-r|--remove-ip-addrs] [-v|--verbose] "
-            "\n\t\t<interface>\n", prog);
+    fprintf(fp, "Usage: %s [-h|--help] [-b|--batch] [-c|--create-ifcfg] [-C|--ip-cmds] [-d|--debug] "
+            "\n\t\t[-D|--daemon] [-F|--force] [-H|--host-map <file>] [-k|--config-cache <file>] "
+            "\n\t\t[-f|--input-file <file>] [-L|--native-lldp] [-l|--log-format <text|json>] "
+            "\n\t\t[-M|--metrics <file>] [-P|--lldpad-clif] [-S|--lldpad-socket <name>] "
+            "\n\t\t[-n|--dry-run] [-r|--remove-ip-addrs] [-T|--trace <file>] [-v|--verbose] "
+            "\n\t\t[-V|--verify] "
+            "\n\t\t[-w|--wait <seconds>] "
+            "\n\t\t[-j|--jobs <n>] <interface>...\n", prog);
 }
 
 void usage_full(const char *prog, FILE *fp)
@@ -388,41 +63,90 @@ void usage_full(const char *prog, FILE *fp)
     fprintf(fp, "\n");
 
     fprintf(fp, "\t-h|--help             show this helpful text\n");
+    fprintf(fp, "\t-b|--batch            validate captured dumps offline instead of configuring interfaces\n");
     fprintf(fp, "\t-c|--create-ifcfg     create corresponding ifcfg file\n");
     fprintf(fp, "\t-d|--debug            enable debug output\n");
+    fprintf(fp, "\t-C|--ip-cmds          apply configuration with ip(8) commands instead of netlink\n");
+    fprintf(fp, "\t-D|--daemon           stay resident and reconfigure when link state or the CrayTLV changes\n");
+    fprintf(fp, "\t-F|--force            apply every step even if the interface already matches the CrayTLV\n");
+    fprintf(fp, "\t-H|--host-map <file>  install neighbour entries for the hosts in file that share\n");
+    fprintf(fp, "\t                      the interface's subnet, once its address is configured\n");
+    fprintf(fp, "\t-k|--config-cache <file> apply the config last applied to each port straight\n");
+    fprintf(fp, "\t                      away, then check it against the CrayTLV, and keep it in file\n");
+    fprintf(fp, "\t-f|--input-file       read lldptool output (or a pcap capture with -L) from a file\n");
+    fprintf(fp, "\t-l|--log-format <fmt> write log lines as 'text' (default) or 'json', one object per line\n");
+    fprintf(fp, "\t-L|--native-lldp      receive the LLDPDU on a raw socket instead of asking lldptool\n");
+    fprintf(fp, "\t-M|--metrics <file>   add attempt, failure and latency counters for each interface\n");
+    fprintf(fp, "\t                      to file, in the Prometheus text format\n");
+    fprintf(fp, "\t-P|--lldpad-clif      ask lldpad over its control socket, one session for every\n");
+    fprintf(fp, "\t                      interface, instead of running lldptool for each query\n");
+    fprintf(fp, "\t-S|--lldpad-socket <name>  lldpad's abstract socket name, implies -P\n");
+    fprintf(fp, "\t-j|--jobs <n>         configure at most n interfaces at a time (default: all)\n");
     fprintf(fp, "\t-n|--dry-run          show the commands to be run but do not run them\n");
     fprintf(fp, "\t-r|--remove-ip-addrs  remove any existing ip addresses\n");
     fprintf(fp, "\t-s|--skip-reload      do not cycle(link up, then link down) the interface to apply configuration\n");
+    fprintf(fp, "\t-T|--trace <file>     write timing spans to file as Chrome trace events\n");
     fprintf(fp, "\t-v|--verbose          enable verbose output\n");
-    fprintf(fp, "\t<interface>           the name of the interface to configure\n");
+    fprintf(fp, "\t-V|--verify           change nothing, compare each interface's CrayTLV with its\n");
+    fprintf(fp, "\t                      current state and print one JSON object per interface;\n");
+    fprintf(fp, "\t                      exits 1 on any mismatch, 2 if some could not be checked.\n");
+    fprintf(fp, "\t                      Every HSN interface without <interface>, -P is fastest\n");
+    fprintf(fp, "\t-w|--wait <seconds>   keep asking for each interface's CrayTLV until it is there or\n");
+    fprintf(fp, "\t                      seconds have passed, and configure it as soon as it arrives\n");
+    fprintf(fp, "\t<interface>...        the interfaces to configure, as names, comma separated\n");
+    fprintf(fp, "\t                      lists, ranges such as hsn[0-7], or 'all' for every HSN\n");
+    fprintf(fp, "\t<dump>...             with -b, dump files, directories of dumps, or @file\n");
+    fprintf(fp, "\t                      listing one dump per line\n");
 }
 
 /* driver */
 int main(int argc, char *argv[])
 {
     int opt;
-    bool ret;
-    fabric_config_t *fc;
-
-    fc = calloc(1, sizeof(*fc));
-    if (!fc) {
-        FATAL("could not allocate a fabric config object");
+    int status;
+    bool ret = true;
+    struct if_result *results;
+    struct program_options *options;
+    struct netcfg *nc;
+    char **ifnames;
+    int count;
+
+    nc = netcfg_new(0);
+    if (!nc) {
+        FATAL("could not allocate configuration state");
     }
+    options = &nc->options;
+    debug_sink = &nc->log;
 
     while (1) {
         const struct option long_options[] = {
             {"help",            no_argument, NULL, 'h'},
+            {"batch",           no_argument, NULL, 'b'},
             {"create-ifcfg",    no_argument, NULL, 'c'},
+            {"daemon",          no_argument, NULL, 'D'},
             {"debug",           no_argument, NULL, 'd'},
+            {"ip-cmds",         no_argument, NULL, 'C'},
             {"dry-run",         no_argument, NULL, 'n'},
+            {"force",           no_argument, NULL, 'F'},
+            {"host-map",        required_argument, NULL, 'H'},
             {"input-file",      required_argument, NULL, 'f'},
+            {"jobs",            required_argument, NULL, 'j'},
+            {"config-cache",    required_argument, NULL, 'k'},
+            {"log-format",      required_argument, NULL, 'l'},
+            {"lldpad-clif",     no_argument, NULL, 'P'},
+            {"lldpad-socket",   required_argument, NULL, 'S'},
+            {"metrics",         required_argument, NULL, 'M'},
+            {"native-lldp",     no_argument, NULL, 'L'},
             {"remove-ip-addrs", no_argument, NULL, 'r'},
             {"skip-reload",     no_argument, NULL, 's'},
+            {"trace",           required_argument, NULL, 'T'},
             {"verbose",         no_argument, NULL, 'v'},
+            {"verify",          no_argument, NULL, 'V'},
+            {"wait",            required_argument, NULL, 'w'},
             { }
         };
 
-        opt = getopt_long(argc, argv, "cdf:hnrv", long_options, NULL);
+        opt = getopt_long(argc, argv, "bcCdDf:FhH:j:k:l:LM:nPrsS:T:vVw:", long_options, NULL);
         if (opt == -1) {
             break;
         }
@@ -431,28 +155,89 @@ int main(int argc, char *argv[])
             case 'h':
                 usage_full(argv[0], stdout);
                 return EXIT_SUCCESS;
+            case 'b':
+                options->batch = true;
+                break;
             case 'c':
-                options.create_ifcfg = true;
+                options->create_ifcfg = true;
+                break;
+            case 'C':
+                options->ip_cmds = true;
                 break;
             case 'd':
-                if (debug_level > DEBUG_LVL_DEBUG)
-                    debug_level = DEBUG_LVL_DEBUG;
+                if (nc->log.level > DEBUG_LVL_DEBUG)
+                    nc->log.level = DEBUG_LVL_DEBUG;
+                break;
+            case 'D':
+                options->daemon = true;
+                break;
+            case 'F':
+                options->force = true;
                 break;
             case 'f':
-                options.input_file = strdup(optarg);
+                options->input_file = strdup(optarg);
+                break;
+            case 'H':
+                options->host_map = strdup(optarg);
+                break;
+            case 'j':
+                options->jobs = atoi(optarg);
+                if (options->jobs < 1) {
+                    usage_brief(argv[0], stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'k':
+                options->config_cache = strdup(optarg);
+                break;
+            case 'l':
+                if (!strcmp(optarg, "json")) {
+                    nc->log.format = DEBUG_FORMAT_JSON;
+                } else if (strcmp(optarg, "text")) {
+                    usage_brief(argv[0], stderr);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'L':
+                options->native_lldp = true;
+                break;
+            case 'M':
+                options->metrics = strdup(optarg);
                 break;
             case 'n':
-                options.dry_run = true;
+                options->dry_run = true;
+                break;
+            case 'P':
+                options->lldpad_clif = true;
+                break;
+            case 'S':
+                options->lldpad_clif = true;
+                options->lldpad_socket = strdup(optarg);
                 break;
             case 'r':
-                options.remove_ip_addrs = true;
+                options->remove_ip_addrs = true;
                 break;
             case 's':
-                options.skip_reload = true;
+                options->skip_reload = true;
+                break;
+            case 'T':
+                if (!trace_open(optarg)) {
+                    return EXIT_FAILURE;
+                }
                 break;
             case 'v':
-                if (debug_level > DEBUG_LVL_VERBOSE)
-                    debug_level = DEBUG_LVL_VERBOSE;
+                if (nc->log.level > DEBUG_LVL_VERBOSE)
+                    nc->log.level = DEBUG_LVL_VERBOSE;
+                break;
+            case 'V':
+                options->verify = true;
+                break;
+            case 'w':
+                options->wait = atoi(optarg);
+                if (options->wait < 1) {
+                    usage_brief(argv[0], stderr);
+                    return EXIT_FAILURE;
+                }
                 break;
             case '?':
                 usage_brief(argv[0], stderr);
@@ -462,26 +247,96 @@ int main(int argc, char *argv[])
         }
     }
 
-    if (argc - optind != 1) {
+    if (argc - optind < 1 && !options->verify) {
         usage_brief(argv[0], stderr);
         return EXIT_FAILURE;
     }
 
-    DEBUG("options.input_file: %s", options.input_file ? options.input_file : "");
+    DEBUG("options.input_file: %s", options->input_file ? options->input_file : "");
 
-    fc->ifname = argv[optind];
-
-    if (!parse_tlv(fc)) {
-        FATAL("failed to parse TLV provided by LLDP");
+    if (options->batch) {
+        ret = run_batch(nc, argv + optind, argc - optind) == EXIT_SUCCESS;
+        netcfg_free(nc);
+        return ret ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-    if (options.create_ifcfg) {
-        ret = write_ifcfg(fc);
+    if (argc - optind < 1) {
+        ifnames = expand_ifnames(1, (char *[]) { "all" }, &count);
     } else {
-        ret = do_ip_cmds(fc);
+        ifnames = expand_ifnames(argc - optind, argv + optind, &count);
+    }
+    if (!count) {
+        FATAL("no interfaces to configure");
+    }
+
+    /* lldpad is only asked, LLDP is not turned on anywhere */
+    if (options->verify) {
+        if (options->lldpad_clif && !options->native_lldp &&
+                !options->input_file) {
+            lldpad_open(nc, NULL, 0);
+        }
+        status = run_verify(nc, ifnames, count);
+        free_ifnames(ifnames, count);
+        netcfg_free(nc);
+        return status;
+    }
+
+    if (options->host_map) {
+        if (options->create_ifcfg) {
+            WARN("--host-map has no effect with --create-ifcfg");
+        } else if (!host_map_load(&nc->host_map, options->host_map)) {
+            FATAL("could not load host map %s", options->host_map);
+        }
+    }
+
+    if (options->config_cache &&
+            !config_cache_load(&nc->cache, options->config_cache)) {
+        FATAL("could not load config cache %s", options->config_cache);
+    }
+
+    if (options->metrics && !metrics_open(&nc->metrics, options->metrics)) {
+        FATAL("could not open metrics file %s", options->metrics);
+    }
+
+    if (options->lldpad_clif && !options->native_lldp && !options->input_file) {
+        lldpad_open(nc, ifnames, count);
+    }
+
+    if (options->daemon) {
+        ret = run_daemon(nc, ifnames, count) == EXIT_SUCCESS;
+        free_ifnames(ifnames, count);
+        netcfg_free(nc);
+        return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    results = calloc(count, sizeof(*results));
+    if (!results) {
+        FATAL("could not allocate a fabric config object");
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i].fc.ifname = ifnames[i];
+    }
+
+    configure_interfaces(nc, results, count);
+
+    for (int i = 0; i < count; i++) {
+        if (count > 1 && options->wait) {
+            printf("%-16s %-7s %6ld ms  tlv %6ld ms  %s\n",
+                    results[i].fc.ifname, results[i].ok ? "OK" : "FAILED",
+                    results[i].elapsed_ms, results[i].tlv_ms,
+                    results[i].status);
+        } else if (count > 1) {
+            printf("%-16s %-7s %6ld ms  %s\n", results[i].fc.ifname,
+                    results[i].ok ? "OK" : "FAILED",
+                    results[i].elapsed_ms, results[i].status);
+        }
+        ret = ret && results[i].ok;
     }
 
-    free(fc);
+    free(results);
+    free_ifnames(ifnames, count);
+    netcfg_free(nc);
 
     return ret ? EXIT_SUCCESS : EXIT_FAILURE;
 }
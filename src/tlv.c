@@ -24,40 +24,413 @@
  * SOFTWARE.
  */
 
-#include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
+#include <arpa/inet.h>
 
 #include "tlv.h"
-#include "utils.h"
+#include "validation.h"
 
 #define ORG_TLV_HEADER "\tOUI: 0x000eab, Subtype: 1, Info: "
 
-void parse_mac_addr(const char *buf, char *mac_addr)
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME        0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *cp = data;
+
+    while (len--) {
+        hash ^= *cp++;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t hash_fabric_config(const fabric_config_t *fc)
 {
-    /* Get our MAC address from the Chassis ID or Port ID TLV */
-    /* It is in both of them */
-    const char *payload = buf + 6;
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    hash = fnv1a(hash, &fc->have, sizeof(fc->have));
+    hash = fnv1a(hash, fc->mac_addr, sizeof(fc->mac_addr));
+    hash = fnv1a(hash, &fc->ip_addr, sizeof(fc->ip_addr));
+    hash = fnv1a(hash, &fc->prefix, sizeof(fc->prefix));
+    hash = fnv1a(hash, &fc->mtu, sizeof(fc->mtu));
+    hash = fnv1a(hash, &fc->ttl, sizeof(fc->ttl));
+
+    return hash;
+}
+
+/* forget everything but the interface */
+void fabric_config_clear(fabric_config_t *fc)
+{
+    char *ifname = fc->ifname;
+
+    memset(fc, 0, sizeof(*fc));
+    fc->ifname = ifname;
+}
+
+/* fields that were not filled in are left empty */
+void fabric_config_format(const fabric_config_t *fc,
+        struct fabric_config_text *text)
+{
+    const uint8_t *mac = fc->mac_addr;
+    char addr[INET_ADDRSTRLEN];
+
+    memset(text, 0, sizeof(*text));
+
+    if (fc->have & FC_HAVE_MAC) {
+        snprintf(text->mac_addr, sizeof(text->mac_addr),
+                "%02x:%02x:%02x:%02x:%02x:%02x",
+                mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+
+    if (fc->have & FC_HAVE_IP) {
+        inet_ntop(AF_INET, &fc->ip_addr, addr, sizeof(addr));
+        snprintf(text->ip_addr, sizeof(text->ip_addr), "%s/%u", addr,
+                fc->prefix);
+    }
+
+    if (fc->have & FC_HAVE_MTU) {
+        snprintf(text->mtu, sizeof(text->mtu), "%u", fc->mtu);
+    }
+
+    if (fc->have & FC_HAVE_TTL) {
+        if (fc->ttl == FC_TTL_FOREVER) {
+            snprintf(text->ttl, sizeof(text->ttl), "forever");
+        } else {
+            snprintf(text->ttl, sizeof(text->ttl), "%u", fc->ttl);
+        }
+    }
+}
 
-    strlcpy(mac_addr, payload, MAC_ADDR_SIZE);
+bool fabric_config_equal(const fabric_config_t *a, const fabric_config_t *b)
+{
+    return a->have == b->have &&
+        !memcmp(a->mac_addr, b->mac_addr, sizeof(a->mac_addr)) &&
+        a->ip_addr.s_addr == b->ip_addr.s_addr &&
+        a->prefix == b->prefix &&
+        a->mtu == b->mtu &&
+        a->ttl == b->ttl;
+}
 
+void mask_mac_addr(uint8_t *mac_addr)
+{
     /* Mask off the second octet of the parsed address */
-    mac_addr[3] = '0';
-    mac_addr[4] = '0';
+    mac_addr[1] = 0;
+}
+
+#define LT_MAC_PREFIX    "\tMAC: "
+#define LT_OUI_PREFIX    "\tOUI: "
+#define LT_DEVICE_NOT_UP "Device not found or inactive"
+
+/* what is left of ORG_TLV_HEADER once LT_OUI_PREFIX has matched */
+#define LT_ORG_HEADER_SKIP (sizeof(ORG_TLV_HEADER) - sizeof(LT_OUI_PREFIX))
+
+#define HEX_INVALID 0xff
+
+static const uint8_t hex_value[256] = {
+    [0 ... 255] = HEX_INVALID,
+    ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3, ['4'] = 0x4,
+    ['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7, ['8'] = 0x8, ['9'] = 0x9,
+    ['a'] = 0xa, ['b'] = 0xb, ['c'] = 0xc, ['d'] = 0xd, ['e'] = 0xe,
+    ['f'] = 0xf, ['A'] = 0xa, ['B'] = 0xb, ['C'] = 0xc, ['D'] = 0xd,
+    ['E'] = 0xe, ['F'] = 0xf,
+};
+
+enum {
+    LT_LINE_START,
+    LT_TAB,
+    LT_MATCH,
+    LT_MAC,
+    LT_ORG_HEADER,
+    LT_ORG_HEX,
+    LT_NOT_UP,
+    LT_SKIP,
+};
+
+void lldptool_parser_init(struct lldptool_parser *p, fabric_config_t *fc,
+        char *org_tlv, size_t org_tlv_size)
+{
+    memset(p, 0, sizeof(*p));
+    p->state = LT_LINE_START;
+    p->fc = fc;
+    p->org_tlv = org_tlv;
+    p->org_tlv_size = org_tlv_size;
+
+    fc->have &= ~FC_HAVE_MAC;
+    org_tlv[0] = '\0';
+}
+
+static void lldptool_parser_match(struct lldptool_parser *p,
+        const char *prefix, int next)
+{
+    p->state = LT_MATCH;
+    p->prefix = prefix;
+    p->pos = 2;
+    p->next = next;
+}
+
+/* called at end of line, and at end of input for an unterminated line */
+static void lldptool_parser_eol(struct lldptool_parser *p)
+{
+    /* a MAC line that does not parse is left in mac_text for the error */
+    if (p->state == LT_MAC &&
+            parse_mac_addr(p->mac_text, p->fc->mac_addr)) {
+        mask_mac_addr(p->fc->mac_addr);
+        p->fc->have |= FC_HAVE_MAC;
+    }
+
+    p->state = LT_LINE_START;
+}
+
+/*
+ * Feed a chunk of 'lldptool get-tlv' output to the parser. Lines may be
+ * split across chunks. Only the first MAC and Org TLV lines are used,
+ * and the Org TLV payload is decoded into the caller's buffer as it is
+ * scanned.
+ */
+void lldptool_parser_feed(struct lldptool_parser *p, const char *buf,
+        size_t len)
+{
+    for (const char *cp = buf, *end = buf + len; cp < end; cp++) {
+        unsigned char c = *cp;
+
+        if (c == '\n') {
+            lldptool_parser_eol(p);
+            continue;
+        }
+
+        switch (p->state) {
+        case LT_LINE_START:
+            if (c == '\t') {
+                p->state = LT_TAB;
+            } else if (c == LT_DEVICE_NOT_UP[0]) {
+                p->state = LT_MATCH;
+                p->prefix = LT_DEVICE_NOT_UP;
+                p->pos = 1;
+                p->next = LT_NOT_UP;
+            } else {
+                p->state = LT_SKIP;
+            }
+            break;
+        case LT_TAB:
+            if (c == 'M' && !p->mac_text[0]) {
+                lldptool_parser_match(p, LT_MAC_PREFIX, LT_MAC);
+            } else if (c == 'O' && !p->org_tlv[0]) {
+                lldptool_parser_match(p, LT_OUI_PREFIX, LT_ORG_HEADER);
+            } else {
+                p->state = LT_SKIP;
+            }
+            break;
+        case LT_MATCH:
+            if (c != (unsigned char) p->prefix[p->pos]) {
+                p->state = LT_SKIP;
+                break;
+            }
+            if (p->prefix[++p->pos]) {
+                break;
+            }
+            if (p->next == LT_NOT_UP) {
+                p->device_not_up = true;
+            }
+            p->state = p->next;
+            p->pos = 0;
+            break;
+        case LT_MAC:
+            if (p->pos < LT_MAC_TEXT_SIZE - 1) {
+                p->mac_text[p->pos++] = c;
+                p->mac_text[p->pos] = '\0';
+            }
+            break;
+        case LT_ORG_HEADER:
+            /*
+             * OUI is unchanging for us (it is the mfg id for Cray), we may
+             * increment subtype if ever we modify the contents of the tlv
+             * payload. Info denotes that the tlv payload follows.
+             */
+            if (++p->pos == LT_ORG_HEADER_SKIP) {
+                p->state = LT_ORG_HEX;
+                p->pos = 0;
+                p->nibble = HEX_INVALID;
+            }
+            break;
+        case LT_ORG_HEX:
+            if (hex_value[c] == HEX_INVALID) {
+                p->state = LT_SKIP;
+            } else if (p->nibble == HEX_INVALID) {
+                p->nibble = hex_value[c];
+            } else if (p->pos < p->org_tlv_size - 1) {
+                p->org_tlv[p->pos++] = p->nibble << 4 | hex_value[c];
+                p->org_tlv[p->pos] = '\0';
+                p->nibble = HEX_INVALID;
+            } else {
+                p->state = LT_SKIP;
+            }
+            break;
+        case LT_NOT_UP:
+        case LT_SKIP:
+        default:
+            break;
+        }
+    }
+}
+
+void lldptool_parser_finish(struct lldptool_parser *p)
+{
+    lldptool_parser_eol(p);
+}
+
+static const char *skip_ws(const char *cp)
+{
+    while (*cp == ' ' || *cp == '\t' || *cp == '\n' || *cp == '\r') {
+        cp++;
+    }
+
+    return cp;
+}
+
+/* a JSON string without escapes, returns the position after its quote */
+static const char *scan_string(const char *cp, const char **str, size_t *len)
+{
+    if (*cp != '"') {
+        return NULL;
+    }
+
+    for (*str = ++cp; *cp != '"'; cp++) {
+        if (!*cp || *cp == '\\' || (unsigned char) *cp < ' ') {
+            return NULL;
+        }
+    }
+    *len = cp - *str;
+
+    return cp + 1;
+}
+
+/* a plain non-negative JSON integer that fits an int */
+static const char *scan_uint(const char *cp, const char **str, size_t *len)
+{
+    for (*str = cp; *cp >= '0' && *cp <= '9'; cp++)
+        ;
+    *len = cp - *str;
+
+    if (!*len || *len > 9 || (**str == '0' && *len > 1)) {
+        return NULL;
+    }
+
+    /* fractions and exponents are left to cJSON */
+    if (*cp == '.' || *cp == 'e' || *cp == 'E') {
+        return NULL;
+    }
+
+    return cp;
 }
 
-void parse_org_tlv(const char *buf, char *org_tlv)
+static bool copy_span(char *dst, size_t size, const char *src, size_t len)
+{
+    if (len >= size) {
+        return false;
+    }
+
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+
+    return true;
+}
+
+static bool key_is(const char *key, size_t len, const char *name)
+{
+    return len == strlen(name) && !memcmp(key, name, len);
+}
+
+/*
+ * Decode the CrayTLV payload in a single pass without building a cJSON
+ * tree. Only the exact schema the switch sends is handled here: an
+ * object with at most one each of ip_addr (string), mtu (integer) and
+ * ttl (integer or string), with values that parse. Anything else returns
+ * false and is left to cJSON, so fc is only written on success.
+ */
+bool craytlv_decode(const char *json, fabric_config_t *fc)
 {
-    const char *payload = buf + strlen(ORG_TLV_HEADER);
-    int length = strlen(payload);
-    int i, j;
+    char ip_addr[IP_ADDR_SIZE] = "";
+    char mtu[MTU_SIZE] = "";
+    char ttl[TTL_SIZE] = "";
+    fabric_config_t parsed = { 0 };
+    const char *cp, *key, *val;
+    size_t key_len, val_len;
+    unsigned int seen = 0;
+    bool ok;
 
-    /* N.B.,
-        OUI is unchanging for us (it is the mfg id for Cray)
-        We may increment subtype if ever we modify the contents
-        of the tlv payload.
-        Info denotes that the tlv payload follows */
-    for (i = 0, j = 0; i < length; i += 2, j++) {
-        org_tlv[j] = hex_to_ascii(payload + i);
+    cp = skip_ws(json);
+    if (*cp++ != '{') {
+        return false;
     }
-    org_tlv[j] = '\0';
+
+    cp = skip_ws(cp);
+    while (*cp != '}') {
+        cp = scan_string(cp, &key, &key_len);
+        if (!cp) {
+            return false;
+        }
+
+        cp = skip_ws(cp);
+        if (*cp++ != ':') {
+            return false;
+        }
+        cp = skip_ws(cp);
+
+        if (key_is(key, key_len, "ip_addr") && !(seen & FC_HAVE_IP)) {
+            seen |= FC_HAVE_IP;
+            cp = scan_string(cp, &val, &val_len);
+            ok = cp && copy_span(ip_addr, sizeof(ip_addr), val, val_len);
+        } else if (key_is(key, key_len, "mtu") && !(seen & FC_HAVE_MTU)) {
+            seen |= FC_HAVE_MTU;
+            cp = scan_uint(cp, &val, &val_len);
+            ok = cp && copy_span(mtu, sizeof(mtu), val, val_len);
+        } else if (key_is(key, key_len, "ttl") && !(seen & FC_HAVE_TTL)) {
+            seen |= FC_HAVE_TTL;
+            if (*cp == '"') {
+                cp = scan_string(cp, &val, &val_len);
+            } else {
+                cp = scan_uint(cp, &val, &val_len);
+            }
+            ok = cp && copy_span(ttl, sizeof(ttl), val, val_len);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            return false;
+        }
+
+        cp = skip_ws(cp);
+        if (*cp == ',') {
+            cp = skip_ws(cp + 1);
+            if (*cp == '}') {
+                return false;
+            }
+        } else if (*cp != '}') {
+            return false;
+        }
+    }
+
+    if (*skip_ws(cp + 1)) {
+        return false;
+    }
+
+    if (((seen & FC_HAVE_IP) &&
+                !parse_ip_prefix(ip_addr, &parsed.ip_addr, &parsed.prefix)) ||
+            ((seen & FC_HAVE_MTU) && !parse_u32(mtu, &parsed.mtu)) ||
+            ((seen & FC_HAVE_TTL) && !parse_ttl(ttl, &parsed.ttl))) {
+        return false;
+    }
+
+    fc->have = (fc->have & ~(FC_HAVE_IP | FC_HAVE_MTU | FC_HAVE_TTL)) | seen;
+    fc->ip_addr = parsed.ip_addr;
+    fc->prefix = parsed.prefix;
+    fc->mtu = parsed.mtu;
+    fc->ttl = parsed.ttl;
+
+    return true;
 }
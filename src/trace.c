@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* local includes */
+#include "debug.h"
+#include "trace.h"
+
+/* external library includes */
+#include "cJSON.h"
+
+#define TRACE_CONTEXT_SIZE 32
+
+static FILE *trace_fp;
+static bool trace_first;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the interface spans on this thread belong to */
+static __thread char trace_context[TRACE_CONTEXT_SIZE];
+
+static uint64_t trace_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * Start writing spans to file in the Chrome trace-event JSON array
+ * format. The array is terminated at exit, but viewers also accept it
+ * unterminated if the process dies first.
+ */
+bool trace_open(const char *file)
+{
+    trace_fp = fopen(file, "w");
+    if (!trace_fp) {
+        ERROR("Unable to open trace file %s: %s", file, strerror(errno));
+        return false;
+    }
+
+    fputs("[\n", trace_fp);
+    trace_first = true;
+    atexit(trace_close);
+
+    return true;
+}
+
+void trace_close(void)
+{
+    pthread_mutex_lock(&trace_lock);
+    if (trace_fp) {
+        fputs("\n]\n", trace_fp);
+        fclose(trace_fp);
+        trace_fp = NULL;
+    }
+    pthread_mutex_unlock(&trace_lock);
+}
+
+void trace_set_context(const char *ifname)
+{
+    snprintf(trace_context, sizeof(trace_context), "%s", ifname ? ifname : "");
+}
+
+void trace_begin(struct trace_span *span, const char *name,
+        const char *detail)
+{
+    span->name = name;
+    span->detail = detail;
+    span->start_us = trace_fp ? trace_now_us() : 0;
+}
+
+void trace_end(struct trace_span *span)
+{
+    uint64_t end_us;
+    cJSON *event, *args;
+    char *line;
+
+    if (!trace_fp) {
+        return;
+    }
+
+    end_us = trace_now_us();
+
+    event = cJSON_CreateObject();
+    if (!event) {
+        return;
+    }
+
+    cJSON_AddStringToObject(event, "name", span->name);
+    cJSON_AddStringToObject(event, "ph", "X");
+    cJSON_AddNumberToObject(event, "ts", span->start_us);
+    cJSON_AddNumberToObject(event, "dur", end_us - span->start_us);
+    cJSON_AddNumberToObject(event, "pid", getpid());
+    cJSON_AddNumberToObject(event, "tid", syscall(SYS_gettid));
+
+    args = cJSON_AddObjectToObject(event, "args");
+    if (args && trace_context[0]) {
+        cJSON_AddStringToObject(args, "ifname", trace_context);
+    }
+    if (args && span->detail) {
+        cJSON_AddStringToObject(args, "detail", span->detail);
+    }
+
+    line = cJSON_PrintUnformatted(event);
+    cJSON_Delete(event);
+    if (!line) {
+        return;
+    }
+
+    pthread_mutex_lock(&trace_lock);
+    if (trace_fp) {
+        fputs(trace_first ? "" : ",\n", trace_fp);
+        fputs(line, trace_fp);
+        trace_first = false;
+    }
+    pthread_mutex_unlock(&trace_lock);
+
+    cJSON_free(line);
+}
@@ -24,44 +24,217 @@
  * SOFTWARE.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
 #include "utils.h"
 #include "debug.h"
+#include "trace.h"
 
-int hex_to_ascii(const char *cp)
-{
-    char buf[3] = { cp[0], cp[1], '\0' };
-
-    return strtol(buf, NULL, 16);
-}
+/* how often runv() tries a step, and its first pause between tries */
+#define RUN_ATTEMPTS   5
+#define RUN_BACKOFF_MS 100
 
 bool run(const char *cmd, bool dry_run)
 {
+    struct trace_span span;
+    bool ret = true;
+
     VERBOSE("Command to execute: %s", cmd);
     if (dry_run)
         return true;
 
+    trace_begin(&span, "run", cmd);
+
+    /* keep our log lines ahead of anything the command prints */
+    debug_flush();
+
     if (system(cmd)) {
         ERROR("'%s' exited with error status", cmd);
-        return false;
+        ret = false;
+    }
+
+    trace_end(&span);
+
+    return ret;
+}
+
+/*
+ * Run steps, up to the one with a NULL cmd, as one transaction. A step
+ * that fails is tried again on its own after a growing pause, so the
+ * steps before it are not repeated. If it never succeeds the steps done
+ * so far are undone, newest first, and false is returned.
+ */
+bool runv(const struct run_step *steps, bool dry_run)
+{
+    int backoff_ms;
+    int attempt;
+    int done;
+
+    for (done = 0; steps[done].cmd; done++) {
+        backoff_ms = RUN_BACKOFF_MS;
+
+        for (attempt = 1; !run(steps[done].cmd, dry_run); attempt++) {
+            if (attempt == RUN_ATTEMPTS) {
+                goto rollback;
+            }
+
+            WARN("retrying '%s' in %d ms, attempt %d of %d",
+                    steps[done].cmd, backoff_ms, attempt + 1, RUN_ATTEMPTS);
+            usleep(backoff_ms * 1000);
+            backoff_ms *= 2;
+        }
     }
 
     return true;
+
+rollback:
+    ERROR("'%s' failed %d times, undoing %d completed step(s)",
+            steps[done].cmd, RUN_ATTEMPTS, done);
+
+    while (done--) {
+        if (!steps[done].undo) {
+            VERBOSE("nothing to undo for '%s'", steps[done].cmd);
+        } else if (!run(steps[done].undo, dry_run)) {
+            WARN("could not undo '%s'", steps[done].cmd);
+        }
+    }
+
+    return false;
 }
 
-bool runv(const char **cmdv, bool dry_run)
+#define SYSFS_NET_DIR "/sys/class/net"
+#define HSN_PREFIX    "hsn"
+#define IFNAME_SIZE   16
+
+/* the most names one range such as hsn[0-7] may expand to */
+#define IFNAME_RANGE_MAX 1024
+
+static bool add_ifname(char ***ifnames, int *count, const char *ifname)
 {
-    int i;
+    char **names;
 
-    for (i = 0; cmdv[i]; i++) {
-        if (!run(cmdv[i], dry_run)) {
-            return false;
+    for (int i = 0; i < *count; i++) {
+        if (!strcmp((*ifnames)[i], ifname)) {
+            return true;
         }
     }
 
+    names = realloc(*ifnames, (*count + 1) * sizeof(*names));
+    if (!names) {
+        return false;
+    }
+    *ifnames = names;
+
+    names[*count] = strdup(ifname);
+    if (!names[*count]) {
+        return false;
+    }
+    (*count)++;
+
     return true;
 }
 
+static int hsn_filter(const struct dirent *ent)
+{
+    return !strncmp(ent->d_name, HSN_PREFIX, strlen(HSN_PREFIX));
+}
+
+static bool add_all_hsn_ifnames(char ***ifnames, int *count)
+{
+    struct dirent **ents;
+    bool ok = true;
+    int n;
+
+    n = scandir(SYSFS_NET_DIR, &ents, hsn_filter, versionsort);
+    if (n < 0) {
+        ERROR("Unable to list %s", SYSFS_NET_DIR);
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (ok) {
+            ok = add_ifname(ifnames, count, ents[i]->d_name);
+        }
+        free(ents[i]);
+    }
+    free(ents);
+
+    return ok;
+}
+
+/*
+ * Expand interface arguments into a list of interface names. Each
+ * argument may be a single name, a comma separated list, a range such
+ * as hsn[0-7], or 'all' for every HSN interface present.
+ */
+char **expand_ifnames(int argc, char **argv, int *count)
+{
+    char **ifnames = NULL;
+    char ifname[IFNAME_SIZE * 2];
+    char prefix[IFNAME_SIZE];
+    int first, last, len;
+
+    *count = 0;
+
+    for (int i = 0; i < argc; i++) {
+        char *spec = strdup(argv[i]);
+        char *save = NULL;
+        char *tok;
+        bool ok = spec != NULL;
+
+        for (tok = spec ? strtok_r(spec, ",", &save) : NULL; ok && tok;
+                tok = strtok_r(NULL, ",", &save)) {
+            len = 0;
+            if (!strcmp(tok, "all")) {
+                ok = add_all_hsn_ifnames(&ifnames, count);
+            } else if (sscanf(tok, "%15[^[][%d-%d]%n",
+                        prefix, &first, &last, &len) == 3 &&
+                    !tok[len]) {
+                if (first > last ||
+                        (long) last - first >= IFNAME_RANGE_MAX) {
+                    ERROR("Invalid interface range '%s'", tok);
+                    ok = false;
+                }
+                for (int unit = first; ok && unit <= last; unit++) {
+                    if (snprintf(ifname, sizeof(ifname), "%s%d",
+                                prefix, unit) >= IFNAME_SIZE) {
+                        ERROR("Invalid interface range '%s'", tok);
+                        ok = false;
+                        break;
+                    }
+                    ok = add_ifname(&ifnames, count, ifname);
+                }
+            } else if (strlen(tok) >= IFNAME_SIZE) {
+                ERROR("Invalid interface name '%s'", tok);
+                ok = false;
+            } else {
+                ok = add_ifname(&ifnames, count, tok);
+            }
+        }
+
+        free(spec);
+
+        if (!ok) {
+            free_ifnames(ifnames, *count);
+            *count = 0;
+            return NULL;
+        }
+    }
+
+    return ifnames;
+}
+
+void free_ifnames(char **ifnames, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(ifnames[i]);
+    }
+    free(ifnames);
+}
+
 size_t  strlcpy(char *d, const char *s, size_t len)
 {
     len--;
@@ -28,116 +28,84 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <getopt.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <arpa/inet.h>
 
 // local includes
+#include "tlv.h"
 #include "validation.h"
 
-// external library includes
-#include "cJSON.h"
-
-#define BUFSIZE       1000
-#define MAC_ADDR_SIZE 24
-#define IP_ADDR_SIZE  32
-#define MTU_SIZE      16
-#define TTL_SIZE      16
-
 #define BASE_DEC 10
-#define BASE_HEX 16
 
-#define IP_PREFIX_MIN 0
 #define IP_PREFIX_MAX 32
 
-#define OCTET_MIN 0
-#define OCTET_MAX 255
-
-bool valid_number(const char *str)
+/* a decimal number that fits in 32 bits, and nothing else */
+bool parse_u32(const char *str, uint32_t *val)
 {
     char *ep = NULL;
-    long val = strtol(str, &ep, BASE_DEC);
+    unsigned long long n;
 
-    if (val < 0 ||
-            ep == str ||
-            *ep) {
+    if (*str < '0' || *str > '9') {
         return false;
     }
 
-    return true;
-}
-
-bool valid_octet(const char **str, int base, char term)
-{
-    char *ep = NULL;
-    long val = strtol(*str, &ep, base);
-
-    if (val < OCTET_MIN ||
-            val > OCTET_MAX ||
-            ep == *str ||
-            *ep != term) {
+    errno = 0;
+    n = strtoull(str, &ep, BASE_DEC);
+    if (errno || *ep || n > UINT32_MAX) {
         return false;
     }
 
-    // why do we do this?
-    *str = ep + 1;
+    *val = n;
 
     return true;
 }
 
-bool valid_mac_addr(const char *mac_addr)
+/* six colon separated hex octets */
+bool parse_mac_addr(const char *str, uint8_t *mac_addr)
 {
-    const char term[6] = { ':', ':', ':', ':', ':', '\0' };
-    const char *str = mac_addr;
-    int i;
-
-    for (i = 0; i < 6; i++) {
-        if (!valid_octet(&str, BASE_HEX, term[i])) {
-            return false;
-        }
-    }
+    int len = 0;
 
-    return true;
+    return sscanf(str, "%2hhx:%2hhx:%2hhx:%2hhx:%2hhx:%2hhx%n",
+            &mac_addr[0], &mac_addr[1], &mac_addr[2],
+            &mac_addr[3], &mac_addr[4], &mac_addr[5], &len) == 6 &&
+        !str[len];
 }
 
-bool valid_ip_addr(const char *ip_addr)
+/* a dotted quad IPv4 address with a prefix length, a.b.c.d/n */
+bool parse_ip_prefix(const char *str, struct in_addr *addr, uint8_t *prefix)
 {
-    /* Return whether or not ip_addr is a valid dotted quad IPv4 Address. */
-    const char term[4] = { '.', '.', '.', '/' };
-    const char *str = ip_addr;
-    int i;
-    char *ep = NULL;
-    long prefix;
+    char addr_str[INET_ADDRSTRLEN];
+    const char *slash = strchr(str, '/');
+    uint32_t len;
 
-    for (i = 0; i < 4; i++) {
-        if (!valid_octet(&str, BASE_DEC, term[i])) {
-            return false;
-        }
+    if (!slash || slash - str >= (long) sizeof(addr_str)) {
+        return false;
     }
 
-    prefix = strtol(str, &ep, BASE_DEC);
-    if (prefix < IP_PREFIX_MIN ||
-            prefix > IP_PREFIX_MAX ||
-            ep == str ||
-            *ep) {
+    memcpy(addr_str, str, slash - str);
+    addr_str[slash - str] = '\0';
+
+    if (inet_pton(AF_INET, addr_str, addr) != 1 ||
+            !parse_u32(slash + 1, &len) || len > IP_PREFIX_MAX) {
         return false;
     }
 
-    return true;
-}
+    *prefix = len;
 
-bool valid_mtu(const char *mtu)
-{
-    return valid_number(mtu);
+    return true;
 }
 
-bool valid_ttl(const char *ttl)
+/* seconds, or "forever" */
+bool parse_ttl(const char *str, uint32_t *ttl)
 {
-    if (!strcmp(ttl, "forever")) {
+    if (!strcmp(str, "forever")) {
+        *ttl = FC_TTL_FOREVER;
         return true;
     }
 
-    return valid_number(ttl);
+    return parse_u32(str, ttl);
 }
 
 void chomp(char *buf)
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <net/if.h>
+
+/* local includes */
+#include "debug.h"
+#include "cfg_lldp.h"
+#include "netlink.h"
+#include "tlv.h"
+
+/* external library includes */
+#include "cJSON.h"
+
+/* exit codes, a mismatch anywhere outweighs an interface not checked */
+#define VERIFY_MATCH    EXIT_SUCCESS
+#define VERIFY_MISMATCH 1
+#define VERIFY_UNKNOWN  2
+
+enum verify_state {
+    VERIFY_STATE_MATCH,
+    VERIFY_STATE_MISMATCH,
+    VERIFY_STATE_ERROR,
+};
+
+static const char *verify_state_names[] = {
+    [VERIFY_STATE_MATCH] = "match",
+    [VERIFY_STATE_MISMATCH] = "mismatch",
+    [VERIFY_STATE_ERROR] = "error",
+};
+
+struct verify_result {
+    struct captured_result base;
+    fabric_config_t kernel;
+    unsigned int mismatch;      /* FC_HAVE_* bits that differ */
+    enum verify_state state;
+};
+
+/* the kernel counts a finite lifetime down, anything up to the TLV's is current */
+static bool lifetime_matches(uint32_t current, uint32_t target)
+{
+    if (current == FC_TTL_FOREVER || target == FC_TTL_FOREVER) {
+        return current == target;
+    }
+
+    return current <= target;
+}
+
+/* read what the kernel has for the interface into res->kernel */
+static bool verify_read_kernel(struct verify_result *res)
+{
+    struct nl_link_state st;
+    struct nl_batch batch;
+    int ifindex;
+    bool ok;
+
+    ifindex = if_nametoindex(res->base.fc.ifname);
+    if (!ifindex) {
+        ERROR("Unable to find interface %s: %s", res->base.fc.ifname,
+                strerror(errno));
+        return false;
+    }
+
+    /* only ever reads, the batch is never committed */
+    if (!nl_batch_init(&batch, false)) {
+        return false;
+    }
+
+    ok = nl_link_state_get(&batch, ifindex, &st);
+    nl_batch_free(&batch);
+
+    if (!ok) {
+        ERROR("Unable to read the state of %s", res->base.fc.ifname);
+        return false;
+    }
+
+    res->kernel.ifname = res->base.fc.ifname;
+    memcpy(res->kernel.mac_addr, st.mac_addr, sizeof(st.mac_addr));
+    res->kernel.mtu = st.mtu;
+    res->kernel.have = FC_HAVE_MAC | FC_HAVE_MTU;
+
+    /* the TLV's address if it is there, else whichever comes first */
+    for (int i = 0; i < st.naddrs; i++) {
+        if (i && st.addrs[i].addr.s_addr != res->base.fc.ip_addr.s_addr) {
+            continue;
+        }
+        res->kernel.ip_addr = st.addrs[i].addr;
+        res->kernel.prefix = st.addrs[i].prefix;
+        res->kernel.ttl = st.addrs[i].valid_lft;
+        res->kernel.have |= FC_HAVE_IP | FC_HAVE_TTL;
+    }
+
+    return true;
+}
+
+static void verify_compare(struct verify_result *res)
+{
+    const fabric_config_t *fc = &res->base.fc, *k = &res->kernel;
+
+    if (memcmp(fc->mac_addr, k->mac_addr, sizeof(fc->mac_addr))) {
+        res->mismatch |= FC_HAVE_MAC;
+    }
+
+    if (!(k->have & FC_HAVE_IP) || fc->ip_addr.s_addr != k->ip_addr.s_addr ||
+            fc->prefix != k->prefix) {
+        res->mismatch |= FC_HAVE_IP;
+    }
+
+    if (fc->mtu != k->mtu) {
+        res->mismatch |= FC_HAVE_MTU;
+    }
+
+    if (!(k->have & FC_HAVE_TTL) || !lifetime_matches(k->ttl, fc->ttl)) {
+        res->mismatch |= FC_HAVE_TTL;
+    }
+
+    res->state = res->mismatch ? VERIFY_STATE_MISMATCH : VERIFY_STATE_MATCH;
+}
+
+static void verify_check(struct captured_result *base)
+{
+    struct verify_result *res = (struct verify_result *) base;
+
+    res->state = VERIFY_STATE_ERROR;
+    if (parse_tlv(base->nc, &base->fc) && verify_read_kernel(res)) {
+        verify_compare(res);
+    }
+}
+
+static bool verify_add_config(cJSON *obj, const char *name,
+        const fabric_config_t *fc)
+{
+    struct fabric_config_text text;
+    cJSON *cfg = cJSON_AddObjectToObject(obj, name);
+
+    if (!cfg) {
+        ERROR("could not allocate a result object");
+        return false;
+    }
+
+    fabric_config_format(fc, &text);
+
+    cJSON_AddStringToObject(cfg, "mac_addr", text.mac_addr);
+    cJSON_AddStringToObject(cfg, "ip_addr", text.ip_addr);
+    cJSON_AddStringToObject(cfg, "mtu", text.mtu);
+    cJSON_AddStringToObject(cfg, "ttl", text.ttl);
+
+    return true;
+}
+
+static bool verify_print(const struct verify_result *res)
+{
+    static const struct {
+        unsigned int bit;
+        const char *name;
+    } fields[] = {
+        { FC_HAVE_MAC, "mac_addr" },
+        { FC_HAVE_IP, "ip_addr" },
+        { FC_HAVE_MTU, "mtu" },
+        { FC_HAVE_TTL, "ttl" },
+    };
+    cJSON *obj = cJSON_CreateObject();
+    cJSON *mismatch;
+    char *line;
+
+    if (!obj) {
+        ERROR("could not allocate a result object");
+        return false;
+    }
+
+    cJSON_AddStringToObject(obj, "ifname", res->base.fc.ifname);
+    cJSON_AddBoolToObject(obj, "ok", res->state == VERIFY_STATE_MATCH);
+    cJSON_AddStringToObject(obj, "state", verify_state_names[res->state]);
+
+    if (res->state == VERIFY_STATE_ERROR) {
+        cJSON_AddStringToObject(obj, "error", res->base.reason.error);
+        cJSON_AddStringToObject(obj, "diag", res->base.reason.diag);
+    } else {
+        if (!verify_add_config(obj, "tlv", &res->base.fc) ||
+                !verify_add_config(obj, "kernel", &res->kernel)) {
+            cJSON_Delete(obj);
+            return false;
+        }
+
+        mismatch = cJSON_AddArrayToObject(obj, "mismatch");
+        for (size_t i = 0; mismatch && i < sizeof(fields) / sizeof(fields[0]);
+                i++) {
+            if (res->mismatch & fields[i].bit) {
+                cJSON_AddItemToArray(mismatch,
+                        cJSON_CreateString(fields[i].name));
+            }
+        }
+    }
+
+    line = cJSON_PrintUnformatted(obj);
+    cJSON_Delete(obj);
+    if (!line) {
+        ERROR("could not format a result object");
+        return false;
+    }
+
+    printf("%s\n", line);
+
+    cJSON_free(line);
+
+    return true;
+}
+
+/*
+ * Compare each interface's CrayTLV with what the kernel has, changing
+ * nothing. One JSON object is printed per interface, in order. Exits
+ * VERIFY_MATCH when every interface matches, VERIFY_MISMATCH when any
+ * does not, and VERIFY_UNKNOWN when some could not be checked.
+ */
+int run_verify(struct netcfg *nc, char **ifnames, int count)
+{
+    struct verify_result *results;
+    int mismatched = 0, failed = 0;
+
+    results = calloc(count, sizeof(*results));
+    if (!results) {
+        ERROR("could not allocate verify results");
+        return VERIFY_UNKNOWN;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i].base.fc.ifname = ifnames[i];
+    }
+
+    run_captured(nc, results, sizeof(*results), count,
+            nc->options.jobs ? nc->options.jobs : count, verify_check);
+
+    for (int i = 0; i < count; i++) {
+        /* a result that could not be printed was not checked */
+        if (!verify_print(&results[i])) {
+            failed++;
+            continue;
+        }
+        mismatched += results[i].state == VERIFY_STATE_MISMATCH;
+        failed += results[i].state == VERIFY_STATE_ERROR;
+    }
+
+    VERBOSE("%d of %d interfaces match their CrayTLV, %d could not be checked",
+            count - mismatched - failed, count, failed);
+
+    free(results);
+
+    if (mismatched) {
+        return VERIFY_MISMATCH;
+    }
+
+    return failed ? VERIFY_UNKNOWN : VERIFY_MATCH;
+}
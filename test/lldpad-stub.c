@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Stands in for lldpad's control interface: set-lldp requests succeed,
+ * get-tlv requests are answered with the hex TLVs canned for the
+ * interface, and every request is printed to stdout. Requests that are
+ * not framed the way lldpad parses them are refused with bad params.
+ *
+ * usage: lldpad-stub <socket name> <ifname>=<file>...
+ */
+
+/* system includes */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* local includes */
+#include "clif.h"
+
+/*
+ * What follows the bridge type is framed as in lldptool's render_cmd():
+ * a TLV id for TLV commands only, then each argument as <len:2><arg>
+ * and its value as <len:4><value>.
+ */
+static bool args_ok(const char *cp, const char *end, unsigned int cmd)
+{
+    unsigned int len;
+
+    if (cmd == CLIF_CMD_GETTLV || cmd == CLIF_CMD_SETTLV) {
+        if (end - cp < 8 || sscanf(cp, "%8x", &len) != 1) {
+            return false;
+        }
+        cp += 8;
+    }
+
+    if (cmd != CLIF_CMD_SET_LLDP) {
+        return cp == end;
+    }
+
+    /* set-lldp always names the setting and gives it a value */
+    if (end - cp < 2 || sscanf(cp, "%2x", &len) != 1 || !len ||
+            end - cp < 2 + (long) len) {
+        return false;
+    }
+    for (cp += 2; len--; cp++) {
+        if (!isalpha((unsigned char) *cp)) {
+            return false;
+        }
+    }
+
+    if (end - cp < 4 || sscanf(cp, "%4x", &len) != 1 || !len) {
+        return false;
+    }
+
+    return end - cp == 4 + (long) len;
+}
+
+static const char *canned_file(int argc, char **argv, const char *ifname)
+{
+    size_t len = strlen(ifname);
+
+    for (int i = 2; i < argc; i++) {
+        if (!strncmp(argv[i], ifname, len) && argv[i][len] == '=') {
+            return argv[i] + len + 1;
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    char req[CLIF_MSG_SIZE + 1], rsp[CLIF_MSG_SIZE], tlvs[CLIF_MSG_SIZE / 2];
+    char ifname[64];
+    struct sockaddr_un addr, peer;
+    socklen_t addr_len, peer_len;
+    unsigned int cmd, ops, iflen;
+    const char *file;
+    int status;
+    ssize_t n;
+    FILE *fp;
+    int fd;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <socket name> <ifname>=<file>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path + 1, argv[1], sizeof(addr.sun_path) - 2);
+    addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + strlen(argv[1]);
+
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *) &addr, addr_len) < 0) {
+        perror("bind");
+        return EXIT_FAILURE;
+    }
+
+    printf("ready\n");
+    fflush(stdout);
+
+    while (1) {
+        peer_len = sizeof(peer);
+        n = recvfrom(fd, req, sizeof(req) - 1, 0,
+                (struct sockaddr *) &peer, &peer_len);
+        if (n < 0) {
+            perror("recvfrom");
+            return EXIT_FAILURE;
+        }
+        req[n] = '\0';
+
+        printf("%s\n", req);
+        fflush(stdout);
+
+        /* M<module:8>C<version:1><cmd:2><ops:8><iflen:2><ifname>... */
+        if (n < 24 || req[0] != CLIF_MOD_CMD || req[9] != CLIF_CMD_REQUEST ||
+                sscanf(req + 11, "%2x%8x%2x", &cmd, &ops, &iflen) != 3 ||
+                iflen >= sizeof(ifname) || 25 + iflen > (unsigned int) n) {
+            snprintf(rsp, sizeof(rsp), "%c%02x", CLIF_CMD_RESPONSE, 4);
+            sendto(fd, rsp, strlen(rsp), 0, (struct sockaddr *) &peer, peer_len);
+            continue;
+        }
+        memcpy(ifname, req + 23, iflen);
+        ifname[iflen] = '\0';
+
+        tlvs[0] = '\0';
+        status = CLIF_STATUS_SUCCESS;
+        file = canned_file(argc, argv, ifname);
+
+        if (!args_ok(req + 23 + iflen + 2, req + n, cmd)) {
+            status = CLIF_STATUS_BAD_PARAMS;
+        } else if (!file) {
+            status = CLIF_STATUS_DEVICE_NOT_FOUND;
+        } else if (cmd == CLIF_CMD_GETTLV) {
+            fp = fopen(file, "r");
+            if (!fp || !fgets(tlvs, sizeof(tlvs), fp)) {
+                status = CLIF_STATUS_PEER_NOT_PRESENT;
+            }
+            if (fp) {
+                fclose(fp);
+            }
+            tlvs[strcspn(tlvs, "\r\n")] = '\0';
+        }
+
+        if (status) {
+            snprintf(rsp, sizeof(rsp), "%c%02x", CLIF_CMD_RESPONSE, status);
+        } else {
+            snprintf(rsp, sizeof(rsp), "%c%02x%c%1x%02x%08x%02x%s%02x%s",
+                    CLIF_CMD_RESPONSE, status, CLIF_CMD_REQUEST,
+                    CLIF_MSG_VERSION, cmd, ops, iflen, ifname,
+                    CLIF_NEAREST_BRIDGE, tlvs);
+        }
+        sendto(fd, rsp, strlen(rsp), 0, (struct sockaddr *) &peer, peer_len);
+    }
+}
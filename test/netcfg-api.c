@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Walks one interface through libslingshot-netcfg the way an agent
+ * would: fetch, parse, validate, plan and apply, in a dry run. Log
+ * messages come back through the callback and are printed to stdout.
+ *
+ * usage: netcfg-api <lldpad socket name> <ifname>
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+
+/* local includes */
+#include "slingshot-netcfg.h"
+
+static void log_msg(void *arg, int level, const char *msg)
+{
+    int *count = arg;
+
+    (*count)++;
+    printf("log %d: %s\n", level, msg);
+}
+
+int main(int argc, char **argv)
+{
+    struct netcfg_config cfg;
+    struct netcfg_plan *plan = NULL;
+    uint8_t tlvs[1500];
+    struct netcfg *nc;
+    int messages = 0;
+    size_t len;
+    bool ok;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <lldpad socket name> <ifname>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    nc = netcfg_new(NETCFG_DRY_RUN);
+    if (!nc || !netcfg_set_lldpad_socket(nc, argv[1])) {
+        return EXIT_FAILURE;
+    }
+    netcfg_set_log(nc, NETCFG_LOG_VERBOSE, log_msg, &messages);
+
+    ok = netcfg_fetch_tlv(nc, argv[2], tlvs, sizeof(tlvs), &len) &&
+        netcfg_parse(nc, argv[2], tlvs, len, &cfg) &&
+        netcfg_validate(nc, &cfg);
+
+    if (ok) {
+        printf("config %s mac %02x:%02x:%02x:%02x:%02x:%02x ip %s/%u "
+                "mtu %u ttl %u\n", cfg.ifname, cfg.mac_addr[0],
+                cfg.mac_addr[1], cfg.mac_addr[2], cfg.mac_addr[3],
+                cfg.mac_addr[4], cfg.mac_addr[5], inet_ntoa(cfg.ip_addr),
+                cfg.prefix, cfg.mtu, cfg.ttl);
+
+        ok = netcfg_plan(nc, &cfg, &plan);
+    }
+
+    if (ok) {
+        for (int i = 0; i < netcfg_plan_steps(plan); i++) {
+            printf("step %d: %s\n", i, netcfg_plan_step(plan, i));
+        }
+
+        ok = netcfg_apply(nc, plan);
+    }
+
+    if (ok) {
+        printf("applied, %d log messages\n", messages);
+    } else {
+        printf("error: %s\n", netcfg_error(nc));
+    }
+
+    netcfg_plan_free(plan);
+    netcfg_free(nc);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright 2026 Hewlett Packard Enterprise Development LP. All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/resource.h>
+#include <arpa/inet.h>
+
+/* local includes */
+#include "debug.h"
+#include "tlv.h"
+#include "lldp.h"
+#include "cfg_lldp.h"
+#include "slingshot-netcfg.h"
+
+/*
+ * Benchmark driver for the TLV parse/validate pipeline. Every result is
+ * written to stdout as one JSON object per line:
+ *
+ *   {"bench":"parse_tlv","case":"success","ops":N,"ns_per_op":...,
+ *    "allocs_per_op":...,"bytes_per_op":...,"peak_rss_kb":...}
+ */
+
+#define BENCH_CORPUS_SIZE 4096
+#define BENCH_MIN_TIME_MS 200
+#define BENCH_BUF_SIZE    16384
+
+/* glibc's allocator, wrapped below so allocations can be counted */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t alloc_count;
+static uint64_t alloc_bytes;
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, size, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    __atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, nmemb * size, __ATOMIC_RELAXED);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, size, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+struct bench_input {
+    char *path;
+    char *buf;
+    size_t len;
+};
+
+struct bench_set {
+    const char *name;
+    struct bench_input *inputs;
+    int count;
+};
+
+typedef void (*bench_fn)(const struct bench_input *in);
+
+static char bench_ifname[] = "hsn0";
+
+static struct netcfg *bench_nc;
+
+static void bench_get_lldp_tlv(const struct bench_input *in)
+{
+    fabric_config_t fc = { .ifname = bench_ifname };
+    char org_tlv[LLDP_ORG_TLV_SIZE];
+
+    get_lldp_tlv(&fc, in->path, org_tlv, sizeof(org_tlv));
+}
+
+static void bench_parse_tlv(const struct bench_input *in)
+{
+    fabric_config_t fc = { .ifname = bench_ifname };
+
+    parse_tlv_input(bench_nc, &fc, in->path);
+}
+
+static void bench_lldptool_parser(const struct bench_input *in)
+{
+    fabric_config_t fc = { .ifname = bench_ifname };
+    struct lldptool_parser parser;
+    char org_tlv[LLDP_ORG_TLV_SIZE];
+
+    lldptool_parser_init(&parser, &fc, org_tlv, sizeof(org_tlv));
+    lldptool_parser_feed(&parser, in->buf, in->len);
+    lldptool_parser_finish(&parser);
+}
+
+static fabric_config_t bench_valid_fc = {
+    .ifname = bench_ifname,
+    .have = FC_HAVE_ALL,
+    .mac_addr = { 0x02, 0x00, 0x00, 0x00, 0x08, 0xb3 },
+    .prefix = 16,
+    .mtu = 9000,
+    .ttl = FC_TTL_FOREVER,
+};
+
+static void bench_is_valid_tlv_data(const struct bench_input *in)
+{
+    is_valid_tlv_data(&bench_valid_fc);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* run fn over the set round robin, doubling ops until min_ms has passed */
+static void bench_run(const char *bench, const struct bench_set *set,
+        bench_fn fn, int min_ms)
+{
+    uint64_t start, elapsed, allocs, bytes;
+    struct rusage ru;
+    long ops = 1;
+
+    for (;;) {
+        allocs = alloc_count;
+        bytes = alloc_bytes;
+        start = now_ns();
+
+        for (long i = 0; i < ops; i++) {
+            fn(&set->inputs[i % set->count]);
+        }
+
+        elapsed = now_ns() - start;
+        allocs = alloc_count - allocs;
+        bytes = alloc_bytes - bytes;
+
+        if (elapsed >= (uint64_t) min_ms * 1000000 || ops >= 1L << 30) {
+            break;
+        }
+        ops *= 2;
+    }
+
+    getrusage(RUSAGE_SELF, &ru);
+
+    printf("{\"bench\":\"%s\",\"case\":\"%s\",\"ops\":%ld,"
+            "\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,"
+            "\"bytes_per_op\":%.1f,\"peak_rss_kb\":%ld}\n",
+            bench, set->name, ops, (double) elapsed / ops,
+            (double) allocs / ops, (double) bytes / ops, ru.ru_maxrss);
+    fflush(stdout);
+}
+
+static bool load_input(struct bench_input *in, const char *path)
+{
+    FILE *fp;
+
+    in->path = strdup(path);
+    in->buf = __libc_malloc(BENCH_BUF_SIZE);
+    if (!in->path || !in->buf) {
+        return false;
+    }
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "unable to open '%s'\n", path);
+        return false;
+    }
+    in->len = fread(in->buf, 1, BENCH_BUF_SIZE, fp);
+    fclose(fp);
+
+    return true;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return *state = x;
+}
+
+static void write_hex(FILE *fp, const char *s)
+{
+    for (; *s; s++) {
+        fprintf(fp, "%02x", (unsigned char) *s);
+    }
+}
+
+/*
+ * A synthetic lldptool dump: the usual TLVs with a random amount of
+ * filler around them, and a CrayTLV with varying field order, spacing
+ * and values.
+ */
+static bool write_synthetic(const char *path, uint32_t *seed)
+{
+    static const char *orders[] = {
+        "{ \"ip_addr\":\"%s\",\"ttl\":%s,\"mtu\": %u}",
+        "{\"mtu\":%3$u,\"ip_addr\":\"%1$s\",\"ttl\":%2$s}",
+        "{ \"ttl\" : %2$s , \"mtu\" : %3$u , \"ip_addr\" : \"%1$s\" }",
+    };
+    char ip_addr[IP_ADDR_SIZE];
+    char ttl[TTL_SIZE];
+    char json[LLDP_ORG_TLV_SIZE];
+    uint32_t r = xorshift32(seed);
+    int filler = r % 64;
+    FILE *fp;
+
+    fp = fopen(path, "w");
+    if (!fp) {
+        return false;
+    }
+
+    snprintf(ip_addr, sizeof(ip_addr), "10.%u.%u.%u/16",
+            r >> 8 & 0xff, r >> 16 & 0xff, r >> 24);
+    if (r & 1) {
+        snprintf(ttl, sizeof(ttl), "\"forever\"");
+    } else {
+        snprintf(ttl, sizeof(ttl), "%u", 60 + (r >> 4 & 0xfff));
+    }
+    snprintf(json, sizeof(json), orders[r % 3], ip_addr, ttl,
+            1500 + (r >> 12 & 0x1fff));
+
+    fprintf(fp, "Chassis ID TLV\n\tMAC: 02:fe:%02x:%02x:%02x:%02x\n",
+            r & 0xff, r >> 8 & 0xff, r >> 16 & 0xff, r >> 24);
+    fprintf(fp, "Port ID TLV\n\tMAC: 02:fe:%02x:%02x:%02x:%02x\n",
+            r & 0xff, r >> 8 & 0xff, r >> 16 & 0xff, r >> 24);
+    fprintf(fp, "Time to Live TLV\n\t120\n");
+
+    for (int i = 0; i < filler; i++) {
+        fprintf(fp, "Port Description TLV\n\tInterface %d as ros0p%d%*s\n",
+                i, i, (int) (xorshift32(seed) % 96), "");
+    }
+
+    fprintf(fp, "Unidentified Org Specific TLV\n"
+            "\tOUI: 0x000eab, Subtype: 1, Info: ");
+    write_hex(fp, json);
+    fprintf(fp, "\nEnd of LLDPDU TLV\n");
+
+    return !fclose(fp);
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int flag,
+        struct FTW *ftw)
+{
+    return remove(path);
+}
+
+void usage(const char *prog, FILE *fp)
+{
+    fprintf(fp, "Usage: %s [-h|--help] [-c|--corpus <n>] "
+            "[-t|--min-time <ms>] <infile>...\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        bench_fn fn;
+    } benches[] = {
+        { "get_lldp_tlv",    bench_get_lldp_tlv },
+        { "parse_tlv",       bench_parse_tlv },
+        { "lldptool_parser", bench_lldptool_parser },
+    };
+    char tmpdir[] = "/tmp/tlv-bench.XXXXXX";
+    char path[sizeof(tmpdir) + 32];
+    struct bench_set *sets;
+    struct bench_set corpus;
+    int corpus_size = BENCH_CORPUS_SIZE;
+    int min_ms = BENCH_MIN_TIME_MS;
+    uint32_t seed = 0x2545f491;
+    int nsets, opt;
+    int ret = EXIT_FAILURE;
+
+    static struct option long_options[] = {
+        {"corpus",   required_argument, NULL, 'c'},
+        {"help",     no_argument,       NULL, 'h'},
+        {"min-time", required_argument, NULL, 't'},
+        {NULL,       0,                 NULL, 0},
+    };
+
+    while ((opt = getopt_long(argc, argv, "c:ht:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c':
+                corpus_size = atoi(optarg);
+                break;
+            case 't':
+                min_ms = atoi(optarg);
+                break;
+            case 'h':
+                usage(argv[0], stdout);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0], stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (corpus_size < 1 || min_ms < 1) {
+        usage(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (inet_pton(AF_INET, "10.253.0.34", &bench_valid_fc.ip_addr) != 1) {
+        return EXIT_FAILURE;
+    }
+
+    /* the failing mock cases would otherwise log on every op */
+    debug_default_sink.level = DEBUG_LVL_MAX;
+
+    bench_nc = netcfg_new(0);
+    if (!bench_nc) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    nsets = argc - optind;
+    sets = calloc(nsets, sizeof(*sets));
+    corpus.inputs = calloc(corpus_size, sizeof(*corpus.inputs));
+    if ((nsets && !sets) || !corpus.inputs) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < nsets; i++) {
+        const char *file = argv[optind + i];
+        const char *base = strrchr(file, '/');
+        char *dot;
+
+        sets[i].name = strdup(base ? base + 1 : file);
+        if (sets[i].name && (dot = strrchr(sets[i].name, '.'))) {
+            *dot = '\0';
+        }
+        sets[i].inputs = calloc(1, sizeof(*sets[i].inputs));
+        sets[i].count = 1;
+        if (!sets[i].name || !sets[i].inputs ||
+                !load_input(sets[i].inputs, file)) {
+            goto out;
+        }
+    }
+
+    if (!mkdtemp(tmpdir)) {
+        perror("mkdtemp");
+        goto out;
+    }
+
+    corpus.name = "synthetic";
+    corpus.count = corpus_size;
+    for (int i = 0; i < corpus_size; i++) {
+        snprintf(path, sizeof(path), "%s/%05d.infile", tmpdir, i);
+        if (!write_synthetic(path, &seed) ||
+                !load_input(&corpus.inputs[i], path)) {
+            fprintf(stderr, "unable to generate '%s'\n", path);
+            goto cleanup;
+        }
+    }
+
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        for (int i = 0; i < nsets; i++) {
+            bench_run(benches[b].name, &sets[i], benches[b].fn, min_ms);
+        }
+        bench_run(benches[b].name, &corpus, benches[b].fn, min_ms);
+    }
+
+    bench_run("is_valid_tlv_data", &corpus, bench_is_valid_tlv_data, min_ms);
+
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    nftw(tmpdir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+out:
+    /* inputs are left for the process exit to release */
+    return ret;
+}